@@ -9,24 +9,142 @@
 
 #include "json.h"
 
+#include <cstring>
 #include <utility>
+#include "json_document.h"
+#include "json_file.h"
+#include "json_lazy.h"
+#include "json_projection.h"
+#include "json_simd.h"
+#include "json_tape.h"
 #include "json_value.h"
+#include "json_validator.h"
 #include "json_exception.h"
 
 namespace lwy {
 
-    void Json::parse(const std::string &content, std::string &status) noexcept {
+    void Json::parse(const std::string &content, std::string &status, json::parse_mode mode) noexcept {
+        parse(content.data(), content.size(), status, mode);
+    }
+
+    void Json::parse(const std::string &content, json::parse_mode mode) {
+        parse(content.data(), content.size(), mode);
+    }
+
+    // 内容非法时不经过异常, 只有内存不足时会进入catch
+    void Json::parse(const char *data, size_t length, std::string &status, json::parse_mode mode) noexcept {
+        try {
+            ParseResult result;
+            parse(data, length, result, mode);
+            status = result.get_message();
+        } catch (...) {
+        }
+    }
+
+    void Json::parse(const char *data, size_t length, json::parse_mode mode) {
+        ParseResult result;
+        parse(data, length, result, mode);
+        if (!result)
+            throw(json::Exception(result.get_message()));
+    }
+
+    void Json::parse(const char *data, size_t length, ParseResult &result, json::parse_mode mode) {
+        size_t offset = 0;
+        json::error_code code = v-> parse(data, data + length, mode, offset);
+        result = ParseResult(code, offset, data);
+    }
+
+    void Json::parse(const std::string &content, ParseResult &result, json::parse_mode mode) {
+        parse(content.data(), content.size(), result, mode);
+    }
+
+    void Json::parse_file(const std::string &path, std::string &status, json::parse_mode mode) noexcept {
         try {
-            parse(content);
-            status = "parse ok";
-        } catch (const json::Exception &msg) {
-            status = msg.what();
+            ParseResult result;
+            parse_file(path, result, mode);
+            status = result.get_message();
         } catch (...) {
         }
     }
 
-    void Json::parse(const std::string &content) {
-        v-> parse(content);
+    void Json::parse_file(const std::string &path, json::parse_mode mode) {
+        ParseResult result;
+        parse_file(path, result, mode);
+        if (!result)
+            throw(json::Exception(result.get_message()));
+    }
+
+    // 解析期间映射保持有效, 解析出的字符串都已拷贝进Value树, result也不引用文件内容, 返回后即可解除映射
+    void Json::parse_file(const std::string &path, ParseResult &result, json::parse_mode mode) {
+        json::MappedFile file;
+        json::error_code code = file.open(path);
+        if (code != json::Ok) {
+            v-> set_type(json::Null);
+            result = ParseResult(code, 0, nullptr);
+            return;
+        }
+        parse(file.data(), file.size(), result, mode);
+    }
+
+    void Json::parse(const char *data, size_t length, const JsonProjection &projection, ParseResult &result,
+                     json::parse_mode mode) {
+        size_t offset = 0;
+        json::error_code code = json::parse_projected(*projection.d, *v, data, data + length, mode, offset);
+        result = ParseResult(code, offset, data);
+    }
+
+    void Json::parse(const char *data, size_t length, const JsonProjection &projection, json::parse_mode mode) {
+        ParseResult result;
+        parse(data, length, projection, result, mode);
+        if (!result)
+            throw(json::Exception(result.get_message()));
+    }
+
+    void Json::parse(const std::string &content, const JsonProjection &projection, json::parse_mode mode) {
+        parse(content.data(), content.size(), projection, mode);
+    }
+
+    JsonProjection::JsonProjection(const std::vector<std::string> &paths) : d(new json::ProjectionData) {
+        json::compile_projection(paths, *d);
+    }
+
+    JsonProjection::~JsonProjection() noexcept = default;
+
+    JsonProjection::JsonProjection(JsonProjection &&rhs) noexcept = default;
+
+    JsonProjection& JsonProjection::operator=(JsonProjection &&rhs) noexcept = default;
+
+    ParseResult Json::validate(const char *data, size_t length) {
+        size_t offset = 0;
+        json::error_code code = json::validate_document(data, data + length, offset);
+        return ParseResult(code, offset, data);
+    }
+
+    LazyJson Json::lazy_parse(const char *data, size_t length) {
+        const char *end = data + length;
+        return LazyJson::make(json::skip_whitespace(data, end), end);
+    }
+
+    LazyJson Json::lazy_parse(const char *content) {
+        return lazy_parse(content, std::strlen(content));
+    }
+
+    LazyJson Json::lazy_parse(const std::string &content) {
+        return lazy_parse(content.data(), content.size());
+    }
+
+    // 行号为偏移之前的换行数加1, 列号为与上一个换行之间的字节数加1; 成功时偏移为0, 不扫描输入
+    ParseResult::ParseResult(json::error_code code, size_t offset, const char *input) noexcept
+            : code_(code), offset_(offset) {
+        size_t line_begin = 0;
+        if (input != nullptr) {
+            const char *p = input, *end = input + offset_;
+            while ((p = static_cast<const char *>(std::memchr(p, '\n', end - p))) != nullptr) {
+                ++line_;
+                line_begin = ++p - input;
+            }
+        }
+        column_ = offset_ - line_begin + 1;
     }
 
     void Json::stringify(std::string &content) const noexcept {
@@ -56,6 +174,31 @@ namespace lwy {
         return *this;
     }
 
+    Json::Json(const JsonView &rhs) noexcept : v(new json::Value(*rhs.v)) { }
+
+    Json::Json(const DocumentView &rhs) noexcept : v(new json::Value) {
+        json::to_value(*rhs.n, *v);
+    }
+
+    Json::Json(const TapeView &rhs) noexcept : v(new json::Value) {
+        json::to_value(*rhs.d, rhs.i, *v);
+    }
+
+    // 只解析句柄所指的值, 其后的内容不检查
+    Json::Json(const LazyJson &rhs) : v(new json::Value) {
+        json::error_code code = json::parse_value_at(rhs.p, rhs.e, *v);
+        if (code != json::Ok)
+            throw(json::Exception(json::error_message(code)));
+    }
+
+    JsonView Json::view() const noexcept {
+        return JsonView(v.get());
+    }
+
+    JsonRef Json::ref() noexcept {
+        return JsonRef(v.get(), v.get());
+    }
+
     void Json::swap(Json &rhs) noexcept {
         using std::swap;
         swap(v, rhs.v);
@@ -88,6 +231,26 @@ namespace lwy {
         v-> set_number(d);
     }
 
+    int Json::get_number_type() const noexcept {
+        return v-> get_number_type();
+    }
+
+    int64_t Json::get_int64() const noexcept {
+        return v-> get_int64();
+    }
+
+    void Json::set_int64(int64_t i) noexcept {
+        v-> set_int64(i);
+    }
+
+    uint64_t Json::get_uint64() const noexcept {
+        return v-> get_uint64();
+    }
+
+    void Json::set_uint64(uint64_t u) noexcept {
+        v-> set_uint64(u);
+    }
+
     const std::string Json::get_string() const noexcept {
         return v-> get_string();
     }
@@ -96,6 +259,10 @@ namespace lwy {
         v-> set_string(str);
     }
 
+    void Json::set_string(std::string &&str) noexcept {
+        v-> set_string(std::move(str));
+    }
+
     size_t Json::get_array_size() const noexcept {
         return v-> get_array_size();
     }
@@ -114,6 +281,10 @@ namespace lwy {
         v-> pushback_array_element(*val.v);
     }
 
+    void Json::pushback_array_element(Json &&val) noexcept {
+        v-> pushback_array_element(std::move(*val.v));
+    }
+
     void Json::popback_array_element() noexcept {
         v-> popback_array_element();
     }
@@ -122,6 +293,10 @@ namespace lwy {
         v-> insert_array_element(*val.v, index);
     }
 
+    void Json::insert_array_element(Json &&val, size_t index) noexcept {
+        v-> insert_array_element(std::move(*val.v), index);
+    }
+
     void Json::erase_array_element(size_t index, size_t count) noexcept {
         v-> erase_array_element(index, count);
     }
@@ -156,6 +331,10 @@ namespace lwy {
         v-> set_object_value(key, *val.v);
     }
 
+    void Json::set_object_value(std::string &&key, Json &&val) noexcept {
+        v-> set_object_value(std::move(key), std::move(*val.v));
+    }
+
     long long Json::find_object_index(const std::string &key) const noexcept {
         return v-> find_object_index(key);
     }
@@ -13,21 +13,101 @@
      2. void stringify(std::string &content) const noexcept
             将content对应的json::Value对象序列化成字符串
      3. void set_xxx() noexcept;
-            在v中设置对应结点类型的值
+            在v中设置对应结点类型的值, 传入右值时移动而不拷贝
      4. void get_xxx() const noexcept;
-            获取v中对应结点类型的C++对象
+            获取v中对应结点类型的C++对象; Number结点可按get_number_type()的存储方式
+            用get_int64/get_uint64精确读取64位整数, get_number总是返回double
      5. void xxx_array_element(...) ...;
             对数组结点类型做相关操作: 入队,出队,插入,删除
      6. xxx_object_xxx(...) ...;
             对Json对象类型做相关操作,键值对存储结构采用pair动态数组实现
+     7. JsonView view() const noexcept; JsonRef ref() noexcept;
+            返回指向解析树中结点的非拥有句柄, 访问子结点时不分配内存、不拷贝子树;
+            JsonRef 另外提供修改接口, 可以就地修改嵌套结点; 句柄在所指结点被删除或Json析构后失效
+     8. void parse(const std::string &content, json::parse_mode mode);
+            字符串与键的原文默认按UTF-8校验, 不合法时报告"parse invalid utf8"(键中的错误与其他键错误一样
+            报告为"parse miss key"); 输入可信时以 json::TrustedUtf8 跳过校验
+     9. void parse(const char *data, size_t length, ...); void parse(std::string_view content, ...);
+            直接解析调用者的缓冲区[data, data+length), 不拷贝也不要求以'\0'结尾; string_view版本需要C++17;
+            只传入const char*时按'\0'结尾的字符串解析
+    10. void parse_file(const std::string &path, ...);
+            把文件映射到内存后直接解析, 并提示内核顺序预读; 无法打开文件时报告"parse cannot open file"
+    11. void parse(..., ParseResult &result, ...); void parse_file(const std::string &path, ParseResult &result, ...);
+            以错误码报告结果, 内容非法时不抛出也不捕获异常, 不构造错误信息字符串; result给出错误码,
+            出错处的字节偏移, 以及出错时即算好的行号与列号(从1开始, 列按字节计), result不引用输入, 输入释放后
+            仍可查询. 只有内存不足时抛出std::bad_alloc.
+            返回status的版本与抛出Exception的版本都建立在此之上
+    12. static ParseResult validate(const char *data, size_t length);
+            只检查[data, data+length)是否为合法的JSON, 语法, 转义, 代理项与数字的规则与parse相同,
+            另外要求内容是合法的UTF-8(向量化的查表法校验, 不合法时报告"parse invalid utf8");
+            不构造结果, 不解码字符串, 也不分配内存
+    13. static LazyJson lazy_parse(const char *data, size_t length); explicit Json(const LazyJson &rhs);
+            按需解析: 不预先解析整个文档, 返回根的LazyJson句柄, 按字段访问时才向后扫描; 缓冲区不拷贝,
+            使用句柄期间必须有效(因此不接受临时的std::string). 需要整棵子树时用Json(lazy)一次性构造
+    14. void parse(const char *data, size_t length, const JsonProjection &projection, ParseResult &result, ...);
+            投影解析: 只构造projection中的路径选中的子树, 路径上的数组与对象只保留走上路径的成员(数组元素
+            保持原来的相对顺序), 其他值不构造; 不构造的值默认仍按Json::parse的语法检查, 错误与位置都相同,
+            mode含json::UncheckedSkip时只按括号与引号配对越过.
+            mode含json::StopWhenFound时, 根对象中各路径的第一段都出现过就结束解析, 耗时只取决于这些键的位置;
+            文档其余部分的错误不会被发现, 因此需要显式打开; 路径以"*"开头或根不是对象时照常读完
+  * JsonProjection类主要成员函数功能:
+     1. explicit JsonProjection(const std::vector<std::string> &paths);
+            按RFC 6901编译路径, 如"/user/id", 段为"*"时匹配任意的键或下标, 空串表示整个文档; 路径不合法时抛出Exception
+  * Document类主要成员函数功能:
+     1. void parse(const std::string &content, std::string &status) noexcept;
+            解析content, 全部结点, 字符串与子结点数组都分配在Document自有的arena中;
+            重新解析或clear时一次性释放, 已申请的内存块留给下次解析复用; 可选的json::parse_mode与Json::parse相同,
+            与Json::parse一样也可以直接解析[data, data+length), const char*或string_view
+     2. DocumentView view() const noexcept;
+            返回根结点的只读句柄, 接口与JsonView相同, 字符串以'\0'结尾的const char*返回;
+            句柄在Document重新解析, clear或析构后失效
+     3. size_t get_memory_usage() const noexcept;
+            arena已向系统申请的字节数
+  * JsonPushParser类主要成员函数功能:
+     1. void feed(const char *data, size_t length);  void finish();
+            分块输入的增量解析, 块可以在任意字节处切分, 结果构造在构造时传入的Json中;
+            语法与错误信息与Json::parse相同, 出错时目标被置为Null并抛出Exception
+  * NdjsonReader类主要成员函数功能:
+     1. NdjsonReader(size_t threads);
+            threads为参与解析的线程数(含调用者), 0表示使用硬件线程数; 线程常驻, 多次parse复用
+     2. void parse(const std::string &content, std::vector<JsonLine> &results);
+            按换行切分NDJSON/JSON Lines内容, 各行在线程池中并行解析, 结果按行的顺序放入results;
+            每行有各自的解析状态, 一行出错不影响其他行; 只含空白的行被跳过
+  * Tape类主要成员函数功能:
+     1. void parse(const std::string &content, std::string &status) noexcept;
+            解析content, 所有值按文档顺序平铺在一个64位字的数组(磁带)中, 字符串另存于一块缓冲区;
+            容器的开始处记录其结束位置, 可以整段跳过; 可选的json::parse_mode与Json::parse相同,
+            输入的形式也与Document::parse相同
+     2. explicit Tape(const JsonView &rhs) noexcept; explicit Json(const TapeView &rhs) noexcept;
+            Value树与磁带的相互转换
+     3. TapeView view() const noexcept;
+            返回根的只读句柄, 接口与DocumentView相同, 访问均不分配内存; get_array_element与
+            get_object_xxx(index)需要逐个跳过前面的子结点, 顺序访问应使用begin()/end()迭代,
+            按键查找使用find; 句柄与迭代器在Tape重新解析, clear或析构后失效
+  * LazyJson类主要成员函数功能:
+     1. LazyJson get_object_value(size_t index) const; long long find_object_index(const std::string &key) const;
+        LazyJson get_array_element(size_t index) const;
+            接口与JsonView相同, 但只扫描到所需的成员为止: 经过的成员的值按括号配对整段越过(SIMD), 不解析;
+            每个句柄记住上次访问的位置, 按文档顺序访问时每个成员只扫描一次, 往回访问时从头重新扫描;
+            按键查找记下经过的键的哈希, 重复的键返回第一个; 下标越界时抛出Exception
+     2. get_type(), get_number(), get_string()等
+            读取标量时才按Json::parse的语法解析此值; 语法错误, 缺少的分隔符与不配对的括号都在访问到时
+            抛出与Json::parse相同信息的Exception, 从未访问的部分(包括根之后的内容)不检查
 **********************************************************************************/
 
 #ifndef JSON_JSON_H
 #define JSON_JSON_H
 
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 
 
 namespace lwy {
@@ -42,13 +122,123 @@ namespace lwy {
             Array,
             Object
         };
+        // Number结点的存储方式: 不带小数和指数且在64位范围内的整数精确存储为整数, 其余为double
+        enum number_type : int{
+            Double,
+            Int64,
+            Uint64
+        };
+        // 解析方式: Recursive逐字节递归下降, 可以与以下各项按位或组合;
+        // TrustedUtf8 输入已知是合法的UTF-8, 跳过字符串原文的UTF-8校验;
+        // 以下两项只用于投影解析: UncheckedSkip 不构造的值只按括号与引号配对越过, 不检查其语法;
+        // StopWhenFound 根对象中要找的键都出现过后立即结束, 之后的内容(包括其中的语法错误)不再读取
+        enum parse_mode : int{
+            Recursive = 0,
+            TrustedUtf8 = 1,
+            UncheckedSkip = 2,
+            StopWhenFound = 4
+        };
+        inline parse_mode operator|(parse_mode lhs, parse_mode rhs) noexcept {
+            return static_cast<parse_mode>(static_cast<int>(lhs) | static_cast<int>(rhs));
+        }
+        // 解析的结果, 每种错误对应一条与抛出的Exception相同的信息, 由error_message给出
+        enum error_code : int{
+            Ok,
+            ExpectValue,
+            InvalidValue,
+            RootNotSingular,
+            NumberTooBig,
+            MissQuotationMark,
+            InvalidStringEscape,
+            InvalidStringChar,
+            InvalidUnicodeHex,
+            InvalidUnicodeSurrogate,
+            MissCommaOrSquareBracket,
+            MissKey,
+            MissColon,
+            MissCommaOrCurlyBracket,
+            CannotOpenFile,
+            CannotMapFile,
+            InvalidUtf8
+        };
+        const char *error_message(error_code code) noexcept;
         class Value;
+        struct Node;
+        struct DocumentData;
+        struct TapeData;
+        struct PushData;
+        struct ProjectionData;
+        class ThreadPool;
     }
 
+    // 不抛出异常的解析结果: 错误码与出错处的字节偏移, 以及由偏移算出的行号与列号; 只在出错时才需要
+    // 从输入的开头数换行, 构造后不引用输入, 因此输入(包括临时的std::string)释放后仍可查询
+    class ParseResult final{
+    public:
+        ParseResult() noexcept = default;
+        // 构造时即由input算出行号与列号, 之后不再引用input
+        ParseResult(json::error_code code, size_t offset, const char *input) noexcept;
+
+        explicit operator bool() const noexcept { return code_ == json::Ok; }
+        json::error_code get_code() const noexcept { return code_; }
+        const char *get_message() const noexcept { return json::error_message(code_); }
+        size_t get_offset() const noexcept { return offset_; }
+        size_t get_line() const noexcept { return line_; }
+        size_t get_column() const noexcept { return column_; }
+    private:
+        json::error_code code_ = json::Ok;
+        size_t offset_ = 0;
+        size_t line_ = 1;
+        size_t column_ = 1;
+    };
+
+    class JsonView;
+    class JsonRef;
+    class DocumentView;
+    class TapeView;
+    class TapeIterator;
+    class LazyJson;
+    class JsonProjection;
+
     class Json final{
     public:
-        void parse(const std::string &content, std::string &status) noexcept;
-        void parse(const std::string &content);
+        void parse(const std::string &content, std::string &status, json::parse_mode mode = json::Recursive) noexcept;
+        void parse(const std::string &content, json::parse_mode mode = json::Recursive);
+        void parse(const char *data, size_t length, std::string &status,
+                   json::parse_mode mode = json::Recursive) noexcept;
+        void parse(const char *data, size_t length, json::parse_mode mode = json::Recursive);
+        // 与std::string及string_view版本并存时, 字符串字面量精确匹配此版本, 不会产生二义性
+        void parse(const char *content, std::string &status, json::parse_mode mode = json::Recursive) noexcept {
+            parse(content, std::strlen(content), status, mode);
+        }
+        void parse(const char *content, json::parse_mode mode = json::Recursive) {
+            parse(content, std::strlen(content), mode);
+        }
+#if __cplusplus >= 201703L
+        void parse(std::string_view content, std::string &status, json::parse_mode mode = json::Recursive) noexcept {
+            parse(content.data(), content.size(), status, mode);
+        }
+        void parse(std::string_view content, json::parse_mode mode = json::Recursive) {
+            parse(content.data(), content.size(), mode);
+        }
+#endif
+        void parse_file(const std::string &path, std::string &status, json::parse_mode mode = json::Recursive) noexcept;
+        void parse_file(const std::string &path, json::parse_mode mode = json::Recursive);
+        void parse(const char *data, size_t length, ParseResult &result, json::parse_mode mode = json::Recursive);
+        void parse(const std::string &content, ParseResult &result, json::parse_mode mode = json::Recursive);
+        void parse_file(const std::string &path, ParseResult &result, json::parse_mode mode = json::Recursive);
+        void parse(const char *data, size_t length, const JsonProjection &projection, ParseResult &result,
+                   json::parse_mode mode = json::Recursive);
+        void parse(const char *data, size_t length, const JsonProjection &projection,
+                   json::parse_mode mode = json::Recursive);
+        void parse(const std::string &content, const JsonProjection &projection, json::parse_mode mode = json::Recursive);
+        static ParseResult validate(const char *data, size_t length);
+        static ParseResult validate(const std::string &content) { return validate(content.data(), content.size()); }
+        // 按需解析, 只定位根的第一个字符; 返回的句柄直接读取[data, data+length), 使用期间缓冲区必须有效
+        static LazyJson lazy_parse(const char *data, size_t length);
+        static LazyJson lazy_parse(const char *content);
+        static LazyJson lazy_parse(const std::string &content);
+        static LazyJson lazy_parse(std::string &&content) = delete;
         void stringify(std::string &content) const noexcept;
 
         Json() noexcept;
@@ -57,8 +247,15 @@ namespace lwy {
         Json& operator=(const Json &rhs) noexcept;
         Json(Json &&rhs) noexcept;
         Json& operator=(Json &&rhs) noexcept;
+        explicit Json(const JsonView &rhs) noexcept;
+        explicit Json(const DocumentView &rhs) noexcept;
+        explicit Json(const TapeView &rhs) noexcept;
+        explicit Json(const LazyJson &rhs);
         void swap(Json &rhs) noexcept;
 
+        JsonView view() const noexcept;
+        JsonRef ref() noexcept;
+
         int get_type() const noexcept;
         void set_null() noexcept;
         void set_boolean(bool b) noexcept;
@@ -67,17 +264,26 @@ namespace lwy {
         double get_number() const noexcept;
         void set_number(double d) noexcept;
         Json& operator=(double d) noexcept { set_number(d); return *this; }
+        int get_number_type() const noexcept;
+        int64_t get_int64() const noexcept;
+        void set_int64(int64_t i) noexcept;
+        uint64_t get_uint64() const noexcept;
+        void set_uint64(uint64_t u) noexcept;
 
         const std::string get_string() const noexcept;
         void set_string(const std::string& str) noexcept;
+        void set_string(std::string&& str) noexcept;
         Json& operator=(const std::string& str) noexcept { set_string(str); return *this; }
+        Json& operator=(std::string&& str) noexcept { set_string(std::move(str)); return *this; }
 
         size_t get_array_size() const noexcept;
         Json get_array_element(size_t index) const noexcept;
         void set_array() noexcept;
         void pushback_array_element(const Json& val) noexcept;
+        void pushback_array_element(Json&& val) noexcept;
         void popback_array_element() noexcept;
         void insert_array_element(const Json &val, size_t index) noexcept;
+        void insert_array_element(Json &&val, size_t index) noexcept;
         void erase_array_element(size_t index, size_t count) noexcept;
         void clear_array() noexcept;
 
@@ -87,18 +293,380 @@ namespace lwy {
         size_t get_object_key_length(size_t index) const noexcept;
         Json get_object_value(size_t index) const noexcept;
         void set_object_value(const std::string &key, const Json &val) noexcept;
+        void set_object_value(std::string &&key, Json &&val) noexcept;
         long long find_object_index(const std::string &key) const noexcept;
         void remove_object_value(size_t index) noexcept;
         void clear_object() noexcept;
     private:
         std::unique_ptr<json::Value> v;
 
+        friend class JsonView;
+        friend class JsonRef;
+        friend class JsonPushParser;
         friend bool operator==(const Json &lhs, const Json &rhs) noexcept;
         friend bool operator!=(const Json &lhs, const Json &rhs) noexcept;
     };
     bool operator==(const Json &lhs, const Json &rhs) noexcept;
     bool operator!=(const Json &lhs, const Json &rhs) noexcept;
     void swap(Json &lhs, Json &rhs) noexcept;
+
+    // 只读句柄, 仅保存指向结点的指针, 拷贝与访问子结点均不分配内存
+    class JsonView final{
+    public:
+        JsonView(const Json &rhs) noexcept;
+
+        void stringify(std::string &content) const noexcept;
+
+        int get_type() const noexcept;
+        double get_number() const noexcept;
+        int get_number_type() const noexcept;
+        int64_t get_int64() const noexcept;
+        uint64_t get_uint64() const noexcept;
+        const std::string& get_string() const noexcept;
+
+        size_t get_array_size() const noexcept;
+        JsonView get_array_element(size_t index) const noexcept;
+
+        size_t get_object_size() const noexcept;
+        const std::string& get_object_key(size_t index) const noexcept;
+        size_t get_object_key_length(size_t index) const noexcept;
+        JsonView get_object_value(size_t index) const noexcept;
+        long long find_object_index(const std::string &key) const noexcept;
+    private:
+        explicit JsonView(const json::Value *val) noexcept : v(val) { }
+
+        const json::Value *v;
+
+        friend class Json;
+        friend class JsonRef;
+        friend class Tape;
+        friend bool operator==(const JsonView &lhs, const JsonView &rhs) noexcept;
+    };
+    bool operator==(const JsonView &lhs, const JsonView &rhs) noexcept;
+    bool operator!=(const JsonView &lhs, const JsonView &rhs) noexcept;
+
+    // 可写句柄, 在原解析树上就地修改结点, 不需要拷出-修改-写回
+    class JsonRef final{
+    public:
+        JsonRef(Json &rhs) noexcept;
+        operator JsonView() const noexcept { return JsonView(v); }
+
+        void stringify(std::string &content) const noexcept;
+
+        int get_type() const noexcept;
+        void set_null() noexcept;
+        void set_boolean(bool b) noexcept;
+
+        double get_number() const noexcept;
+        void set_number(double d) noexcept;
+        int get_number_type() const noexcept;
+        int64_t get_int64() const noexcept;
+        void set_int64(int64_t i) noexcept;
+        uint64_t get_uint64() const noexcept;
+        void set_uint64(uint64_t u) noexcept;
+
+        const std::string& get_string() const noexcept;
+        void set_string(const std::string& str) noexcept;
+        void set_string(std::string&& str) noexcept;
+
+        // 用val替换所指结点的值; val可以是所指结点本身或其所在的整棵树
+        void set_value(const Json &val) noexcept;
+        void set_value(Json &&val) noexcept;
+
+        size_t get_array_size() const noexcept;
+        JsonRef get_array_element(size_t index) const noexcept;
+        void set_array() noexcept;
+        void pushback_array_element(const Json& val) noexcept;
+        void pushback_array_element(Json&& val) noexcept;
+        void popback_array_element() noexcept;
+        void insert_array_element(const Json &val, size_t index) noexcept;
+        void insert_array_element(Json &&val, size_t index) noexcept;
+        void erase_array_element(size_t index, size_t count) noexcept;
+        void clear_array() noexcept;
+
+        void set_object() noexcept;
+        size_t get_object_size() const noexcept;
+        const std::string& get_object_key(size_t index) const noexcept;
+        size_t get_object_key_length(size_t index) const noexcept;
+        JsonRef get_object_value(size_t index) const noexcept;
+        void set_object_value(const std::string &key, const Json &val) noexcept;
+        void set_object_value(std::string &&key, Json &&val) noexcept;
+        long long find_object_index(const std::string &key) const noexcept;
+        void remove_object_value(size_t index) noexcept;
+        void clear_object() noexcept;
+    private:
+        JsonRef(json::Value *tree, json::Value *val) noexcept : root(tree), v(val) { }
+
+        json::Value *root;  // 所在树的根, 用于识别val与所指结点的重叠
+        json::Value *v;
+
+        friend class Json;
+    };
+
+    // 分块输入的增量解析器, 每块到达后立即解析, 不需要先拼接出完整的文档;
+    // 目标Json在解析期间不能被修改或移动
+    class JsonPushParser final{
+    public:
+        explicit JsonPushParser(Json &target) noexcept;
+        ~JsonPushParser() noexcept;
+        JsonPushParser(const JsonPushParser &rhs) = delete;
+        JsonPushParser& operator=(const JsonPushParser &rhs) = delete;
+
+        void feed(const char *data, size_t length);
+        void feed(const std::string &chunk) { feed(chunk.data(), chunk.size()); }
+        void finish();
+        void finish(std::string &status) noexcept;
+        // 目标置为Null, 开始解析下一个文档
+        void reset() noexcept;
+    private:
+        Json &target_;
+        std::unique_ptr<json::PushData> d;
+    };
+
+    // NDJSON中一行的解析结果
+    struct JsonLine {
+        Json value;
+        std::string status;     // "parse ok"或错误信息, 出错时value为Null
+        size_t line;            // 行号, 从1开始
+    };
+
+    // 每行一个JSON值的NDJSON/JSON Lines解析器, 各行分给线程池并行解析
+    class NdjsonReader final{
+    public:
+        explicit NdjsonReader(size_t threads = 0);
+        ~NdjsonReader() noexcept;
+        NdjsonReader(const NdjsonReader &rhs) = delete;
+        NdjsonReader& operator=(const NdjsonReader &rhs) = delete;
+
+        void parse(const std::string &content, std::vector<JsonLine> &results);
+        size_t get_thread_count() const noexcept;
+    private:
+        std::unique_ptr<json::ThreadPool> pool;
+    };
+
+    // 整棵树分配在arena中的只读文档, 适合解析-读取-丢弃的场景
+    class Document final{
+    public:
+        void parse(const std::string &content, std::string &status, json::parse_mode mode = json::Recursive) noexcept;
+        void parse(const std::string &content, json::parse_mode mode = json::Recursive);
+        void parse(const char *data, size_t length, std::string &status,
+                   json::parse_mode mode = json::Recursive) noexcept;
+        void parse(const char *data, size_t length, json::parse_mode mode = json::Recursive);
+        void parse(const char *content, std::string &status, json::parse_mode mode = json::Recursive) noexcept {
+            parse(content, std::strlen(content), status, mode);
+        }
+        void parse(const char *content, json::parse_mode mode = json::Recursive) {
+            parse(content, std::strlen(content), mode);
+        }
+#if __cplusplus >= 201703L
+        void parse(std::string_view content, std::string &status, json::parse_mode mode = json::Recursive) noexcept {
+            parse(content.data(), content.size(), status, mode);
+        }
+        void parse(std::string_view content, json::parse_mode mode = json::Recursive) {
+            parse(content.data(), content.size(), mode);
+        }
+#endif
+        void stringify(std::string &content) const noexcept;
+        void clear() noexcept;
+
+        Document() noexcept;
+        ~Document() noexcept;
+        Document(const Document &rhs) = delete;
+        Document& operator=(const Document &rhs) = delete;
+        Document(Document &&rhs) noexcept;
+        Document& operator=(Document &&rhs) noexcept;
+
+        DocumentView view() const noexcept;
+        size_t get_memory_usage() const noexcept;
+    private:
+        std::unique_ptr<json::DocumentData> d;
+    };
+
+    // Document中结点的只读句柄, 拷贝与访问子结点均不分配内存
+    class DocumentView final{
+    public:
+        void stringify(std::string &content) const noexcept;
+
+        int get_type() const noexcept;
+        double get_number() const noexcept;
+        int get_number_type() const noexcept;
+        int64_t get_int64() const noexcept;
+        uint64_t get_uint64() const noexcept;
+        const char *get_string() const noexcept;
+        size_t get_string_length() const noexcept;
+
+        size_t get_array_size() const noexcept;
+        DocumentView get_array_element(size_t index) const noexcept;
+
+        size_t get_object_size() const noexcept;
+        const char *get_object_key(size_t index) const noexcept;
+        size_t get_object_key_length(size_t index) const noexcept;
+        DocumentView get_object_value(size_t index) const noexcept;
+        long long find_object_index(const std::string &key) const noexcept;
+    private:
+        explicit DocumentView(const json::Node *node) noexcept : n(node) { }
+
+        const json::Node *n;
+
+        friend class Json;
+        friend class Document;
+    };
+
+    // 按文档顺序平铺在磁带上的只读文档, 遍历与序列化都是顺序访问内存
+    class Tape final{
+    public:
+        void parse(const std::string &content, std::string &status, json::parse_mode mode = json::Recursive) noexcept;
+        void parse(const std::string &content, json::parse_mode mode = json::Recursive);
+        void parse(const char *data, size_t length, std::string &status,
+                   json::parse_mode mode = json::Recursive) noexcept;
+        void parse(const char *data, size_t length, json::parse_mode mode = json::Recursive);
+        void parse(const char *content, std::string &status, json::parse_mode mode = json::Recursive) noexcept {
+            parse(content, std::strlen(content), status, mode);
+        }
+        void parse(const char *content, json::parse_mode mode = json::Recursive) {
+            parse(content, std::strlen(content), mode);
+        }
+#if __cplusplus >= 201703L
+        void parse(std::string_view content, std::string &status, json::parse_mode mode = json::Recursive) noexcept {
+            parse(content.data(), content.size(), status, mode);
+        }
+        void parse(std::string_view content, json::parse_mode mode = json::Recursive) {
+            parse(content.data(), content.size(), mode);
+        }
+#endif
+        void stringify(std::string &content) const noexcept;
+        void clear() noexcept;
+
+        Tape() noexcept;
+        ~Tape() noexcept;
+        Tape(const Tape &rhs) = delete;
+        Tape& operator=(const Tape &rhs) = delete;
+        Tape(Tape &&rhs) noexcept;
+        Tape& operator=(Tape &&rhs) noexcept;
+        explicit Tape(const JsonView &rhs) noexcept;
+
+        TapeView view() const noexcept;
+        size_t get_memory_usage() const noexcept;
+    private:
+        std::unique_ptr<json::TapeData> d;
+    };
+
+    // 磁带上一个值的只读句柄, 仅保存磁带与位置, 拷贝与访问子结点均不分配内存
+    class TapeView final{
+    public:
+        void stringify(std::string &content) const noexcept;
+
+        int get_type() const noexcept;
+        double get_number() const noexcept;
+        int get_number_type() const noexcept;
+        int64_t get_int64() const noexcept;
+        uint64_t get_uint64() const noexcept;
+        const char *get_string() const noexcept;
+        size_t get_string_length() const noexcept;
+
+        size_t get_array_size() const noexcept;
+        TapeView get_array_element(size_t index) const noexcept;
+
+        size_t get_object_size() const noexcept;
+        const char *get_object_key(size_t index) const noexcept;
+        size_t get_object_key_length(size_t index) const noexcept;
+        TapeView get_object_value(size_t index) const noexcept;
+        long long find_object_index(const std::string &key) const noexcept;
+        // 返回键为key的第一个成员, 不存在时返回end()
+        TapeIterator find(const std::string &key) const noexcept;
+
+        // 依次访问数组的元素或对象的成员
+        TapeIterator begin() const noexcept;
+        TapeIterator end() const noexcept;
+    private:
+        TapeView(const json::TapeData *data, size_t index) noexcept : d(data), i(index) { }
+        size_t member(size_t index) const noexcept;
+
+        const json::TapeData *d;
+        size_t i;
+
+        friend class Json;
+        friend class Tape;
+        friend class TapeIterator;
+    };
+
+    // 数组元素或对象成员的迭代器, *it为元素或成员的值, 对象成员的键由get_key读取
+    class TapeIterator final{
+    public:
+        TapeView operator*() const noexcept;
+        const char *get_key() const noexcept;
+        size_t get_key_length() const noexcept;
+        TapeIterator& operator++() noexcept;
+    private:
+        TapeIterator(const json::TapeData *data, size_t index, bool is_object) noexcept
+                : d(data), i(index), object(is_object) { }
+
+        const json::TapeData *d;
+        size_t i;           // 当前元素, 或当前成员的键在磁带上的位置
+        bool object;
+
+        friend class TapeView;
+        friend bool operator==(const TapeIterator &lhs, const TapeIterator &rhs) noexcept;
+    };
+    bool operator==(const TapeIterator &lhs, const TapeIterator &rhs) noexcept;
+    bool operator!=(const TapeIterator &lhs, const TapeIterator &rhs) noexcept;
+
+    // 预先编译好的一组JSON Pointer路径, 供投影解析反复使用; 段为"*"时匹配任意的键或数组下标
+    class JsonProjection final{
+    public:
+        explicit JsonProjection(const std::vector<std::string> &paths);
+        ~JsonProjection() noexcept;
+        JsonProjection(JsonProjection &&rhs) noexcept;
+        JsonProjection& operator=(JsonProjection &&rhs) noexcept;
+        JsonProjection(const JsonProjection &rhs) = delete;
+        JsonProjection& operator=(const JsonProjection &rhs) = delete;
+    private:
+        std::unique_ptr<json::ProjectionData> d;
+
+        friend class Json;
+    };
+
+    // 按需解析的只读句柄, 只保存值在输入中的位置, 访问到哪里才扫描到哪里; 经过而不访问的值只按括号与引号
+    // 配对越过, 不检查其内部. 访问到的部分(经过的键, 分隔符, 以及读取的值)与Json::parse报告相同的错误并抛出Exception
+    class LazyJson final{
+    public:
+        int get_type() const;
+        double get_number() const;
+        int get_number_type() const;
+        int64_t get_int64() const;
+        uint64_t get_uint64() const;
+        std::string get_string() const;
+
+        size_t get_array_size() const;
+        LazyJson get_array_element(size_t index) const;
+
+        size_t get_object_size() const;
+        std::string get_object_key(size_t index) const;
+        LazyJson get_object_value(size_t index) const;
+        // 有重复的键时返回第一个, 与Json相同
+        long long find_object_index(const std::string &key) const;
+    private:
+        LazyJson(const char *value, const char *end) noexcept : p(value), e(end) { }
+        static LazyJson make(const char *value, const char *end);
+        bool closes(const char *member) const noexcept;
+        const char *first_member() const;
+        const char *next_member(const char *value) const;
+        const char *seek(size_t index) const;
+        const char *member(size_t index) const;
+        size_t count_members() const;
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        const char *p;                          // 值的第一个字符
+        const char *e;                          // 输入的末尾
+        // 容器中最近访问的成员(对象为键的开引号)及其序号, 之后的访问从这里继续向后扫描
+        mutable const char *cur = nullptr;
+        mutable size_t cur_index = 0;
+        mutable size_t count = npos;            // 成员数, 数出之前为npos
+        mutable std::vector<uint64_t> key_hashes;   // 按键查找时经过的前若干个成员的键的哈希
+
+        friend class Json;
+    };
 }
 
 
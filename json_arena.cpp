@@ -0,0 +1,79 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_arena.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现Arena类
+**********************************************************************************/
+
+#include "json_arena.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace lwy {
+
+    namespace json {
+
+        // 新块大小翻倍的上限, 超过上限的大分配单独占用一块
+        static const size_t max_chunk_size = 16 * 1024 * 1024;
+
+        Arena::~Arena() noexcept {
+            reset();
+            while (free_) {
+                Chunk *next = free_->next;
+                std::free(free_);
+                free_ = next;
+            }
+        }
+
+        // 当前块放不下时, 先在空闲块中找足够大的, 找不到再申请新块; 当前块剩余的空间不再使用
+        void *Arena::allocate_slow(size_t size, size_t align) {
+            const size_t need = size + align;
+            Chunk **prev = &free_;
+            Chunk *chunk = free_;
+            while (chunk && chunk->size < need) {
+                prev = &chunk->next;
+                chunk = chunk->next;
+            }
+            if (chunk) {
+                *prev = chunk->next;
+            } else {
+                size_t chunk_size = chunk_size_ > need ? chunk_size_ : need;
+                if (chunk_size_ < max_chunk_size)
+                    chunk_size_ *= 2;
+                chunk = static_cast<Chunk *>(std::malloc(sizeof(Chunk) + chunk_size));
+                if (chunk == nullptr)
+                    throw std::bad_alloc();
+                chunk->size = chunk_size;
+                capacity_ += sizeof(Chunk) + chunk_size;
+            }
+            chunk->next = used_;
+            used_ = chunk;
+            ptr_ = reinterpret_cast<char *>(chunk + 1);
+            limit_ = ptr_ + chunk->size;
+            return allocate(size, align);
+        }
+
+        char *Arena::copy_string(const char *str, size_t length) {
+            char *p = static_cast<char *>(allocate(length + 1, 1));
+            std::memcpy(p, str, length);
+            p[length] = '\0';
+            return p;
+        }
+
+        void Arena::reset() noexcept {
+            while (used_) {
+                Chunk *next = used_->next;
+                used_->next = free_;
+                free_ = used_;
+                used_ = next;
+            }
+            ptr_ = limit_ = nullptr;
+        }
+
+    }
+
+}
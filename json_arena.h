@@ -0,0 +1,66 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_arena.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明Arena类, 一个只增不减的内存池: 从大块内存中顺序切分, 不单独释放,
+  *              整体重置或析构时按块释放, 代价只与块数有关
+  *Function List:
+  * Arena类主要成员函数功能:
+     1. void *allocate(size_t size, size_t align);
+            分配size字节并按align对齐, 当前块不够时取用空闲块或申请新块; 内存不足时抛出std::bad_alloc
+     2. char *copy_string(const char *str, size_t length);
+            把字符串拷贝到池中并补上'\0'
+     3. void reset() noexcept;
+            释放全部分配, 已申请的块留作空闲块, 下次分配时复用
+     4. size_t capacity() const noexcept;
+            已向系统申请的总字节数
+**********************************************************************************/
+
+#ifndef JSON_JSON_ARENA_H
+#define JSON_JSON_ARENA_H
+
+#include <cstddef>
+
+namespace lwy {
+
+    namespace json {
+
+        class Arena final{
+        public:
+            explicit Arena(size_t chunk_size = 64 * 1024) noexcept : chunk_size_(chunk_size) { }
+            ~Arena() noexcept;
+            Arena(const Arena &) = delete;
+            Arena& operator=(const Arena &) = delete;
+
+            void *allocate(size_t size, size_t align) {
+                char *p = ptr_ + ((0 - reinterpret_cast<size_t>(ptr_)) & (align - 1));
+                if (ptr_ == nullptr || p + size > limit_)
+                    return allocate_slow(size, align);
+                ptr_ = p + size;
+                return p;
+            }
+            char *copy_string(const char *str, size_t length);
+            void reset() noexcept;
+            size_t capacity() const noexcept { return capacity_; }
+        private:
+            struct Chunk {
+                Chunk *next;
+                size_t size;    // 不含Chunk头的可用字节数
+            };
+            void *allocate_slow(size_t size, size_t align);
+
+            Chunk *used_ = nullptr;    // 正在使用的块, 链表头为当前块
+            Chunk *free_ = nullptr;    // reset后留待复用的块
+            char *ptr_ = nullptr;
+            char *limit_ = nullptr;
+            size_t chunk_size_;        // 下一个新块的大小, 每次翻倍直到上限
+            size_t capacity_ = 0;
+        };
+
+    }
+
+}
+
+#endif //JSON_JSON_ARENA_H
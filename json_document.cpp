@@ -0,0 +1,308 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_document.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现DocumentBuilder类, 以及对外的Document与DocumentView类
+**********************************************************************************/
+
+#include "json_document.h"
+
+#include <cassert>
+#include <cstring>
+#include <utility>
+#include "json_exception.h"
+#include "json_generator.h"
+#include "json_number.h"
+#include "json_reader.h"
+
+namespace lwy {
+
+    namespace json {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "json::Node assumes a little-endian layout"
+#endif
+        static_assert(sizeof(Node) == 16, "Node must stay 16 bytes");
+
+        const int Node::kind_types[16] = {
+            json::String, json::Null, json::True, json::False,
+            json::Number, json::Number, json::Number, json::String, json::Array, json::Object,
+        };
+
+        double Node::get_number() const noexcept {
+            switch (kind()) {
+                case kind_int64: return static_cast<double>(static_cast<int64_t>(words_[0]));
+                case kind_uint64: return static_cast<double>(words_[0]);
+                default: {
+                    double d;
+                    std::memcpy(&d, &words_[0], sizeof(d));
+                    return d;
+                }
+            }
+        }
+
+        int64_t Node::get_int64() const noexcept {
+            return kind() == kind_double ? double_to_int64(get_number()) : static_cast<int64_t>(words_[0]);
+        }
+
+        uint64_t Node::get_uint64() const noexcept {
+            return kind() == kind_double ? double_to_uint64(get_number()) : words_[0];
+        }
+
+        void Node::set_literal(json::type t) noexcept {
+            set(t == json::Null ? kind_null : t == json::True ? kind_true : kind_false, 0, 0);
+        }
+
+        void Node::set_double(double d) noexcept {
+            uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(d));
+            set(kind_double, bits, 0);
+        }
+
+        bool Node::set_short_string(const char *str, size_t length) noexcept {
+            if (length > max_inline_length)
+                return false;
+            words_[0] = words_[1] = 0;
+            std::memcpy(words_, str, length);
+            reinterpret_cast<unsigned char *>(words_)[15] = static_cast<unsigned char>(max_inline_length - length);
+            return true;
+        }
+
+        void Node::set_long_string(const char *str, size_t length, bool escape_free) noexcept {
+            set_pointer(kind_string, str, length, escape_free ? 1 : 0);
+        }
+
+        // 短字符串(包括大多数键)直接放在结点中, 不占用arena
+        void DocumentBuilder::on_string(const char *str, size_t length, bool escape_free) {
+            Node &n = push();
+            if (!n.set_short_string(str, length))
+                n.set_long_string(arena_.copy_string(str, length), length, escape_free);
+        }
+
+        const Node *DocumentBuilder::pop_to_arena(size_t n) {
+            if (n == 0)
+                return nullptr;
+            Node *dst = static_cast<Node *>(arena_.allocate(n * sizeof(Node), alignof(Node)));
+            std::memcpy(dst, stack_.data() + stack_.size() - n, n * sizeof(Node));
+            stack_.resize(stack_.size() - n);
+            return dst;
+        }
+
+        void DocumentBuilder::on_end_array(size_t count) {
+            const Node *elements = pop_to_arena(count);
+            push().set_array(elements, count);
+        }
+
+        void DocumentBuilder::on_end_object(size_t count) {
+            // 栈顶依次是 键, 值, 键, 值..., 与Member数组的内存布局相同
+            static_assert(sizeof(Member) == 2 * sizeof(Node), "Member must be two adjacent nodes");
+            const Member *members = reinterpret_cast<const Member *>(pop_to_arena(2 * count));
+            push().set_object(members, count);
+        }
+
+        error_code parse_document(DocumentData &data, const char *content, size_t length, parse_mode mode) {
+            data.arena.reset();
+            data.stack.clear();
+            data.root.set_literal(json::Null);
+            error_code code;
+            try {
+                DocumentBuilder builder(data);
+                code = Reader<DocumentBuilder>(builder, content, content + length, !(mode & json::TrustedUtf8)).parse();
+            } catch (...) {
+                data.arena.reset();
+                data.stack.clear();
+                throw;
+            }
+            if (code != json::Ok) {
+                data.arena.reset();
+                data.stack.clear();
+                return code;
+            }
+            assert(data.stack.size() == 1);
+            data.root = data.stack.back();
+            data.stack.clear();
+            return json::Ok;
+        }
+
+        void to_value(const Node &node, Value &v) noexcept {
+            switch (node.get_type()) {
+                case json::Number:
+                    if (node.get_number_type() == json::Int64) v.set_int64(node.get_int64());
+                    else if (node.get_number_type() == json::Uint64) v.set_uint64(node.get_uint64());
+                    else v.set_number(node.get_number());
+                    break;
+                case json::String:
+                    v.set_string(std::string(node.get_string(), node.size()));
+                    break;
+                case json::Array: {
+                    std::vector<Value> arr(node.size());
+                    for (size_t i = 0; i < arr.size(); ++i)
+                        to_value(node.get_elements()[i], arr[i]);
+                    v.set_array(std::move(arr));
+                    break;
+                }
+                case json::Object: {
+                    std::vector<std::pair<std::string, Value>> obj(node.size());
+                    for (size_t i = 0; i < obj.size(); ++i) {
+                        const Member &m = node.get_members()[i];
+                        obj[i].first.assign(m.key.get_string(), m.key.size());
+                        to_value(m.value, obj[i].second);
+                    }
+                    v.set_object(std::move(obj));
+                    break;
+                }
+                default:
+                    v.set_type(static_cast<json::type>(node.get_type()));
+                    break;
+            }
+        }
+
+        // 被移动后的Document没有数据, 视图指向这个Null结点
+        static Node make_null_node() noexcept {
+            Node n;
+            n.set_literal(json::Null);
+            return n;
+        }
+        static const Node null_node = make_null_node();
+
+    }
+
+
+    Document::Document() noexcept : d(new json::DocumentData) {
+        d->root.set_literal(json::Null);
+    }
+
+    Document::~Document() noexcept = default;
+
+    Document::Document(Document &&rhs) noexcept = default;
+
+    Document& Document::operator=(Document &&rhs) noexcept = default;
+
+    void Document::parse(const std::string &content, std::string &status, json::parse_mode mode) noexcept {
+        parse(content.data(), content.size(), status, mode);
+    }
+
+    void Document::parse(const std::string &content, json::parse_mode mode) {
+        parse(content.data(), content.size(), mode);
+    }
+
+    void Document::parse(const char *data, size_t length, std::string &status, json::parse_mode mode) noexcept {
+        try {
+            if (d == nullptr)
+                d.reset(new json::DocumentData);
+            status = json::error_message(json::parse_document(*d, data, length, mode));
+        } catch (...) {
+        }
+    }
+
+    void Document::parse(const char *data, size_t length, json::parse_mode mode) {
+        if (d == nullptr)
+            d.reset(new json::DocumentData);
+        json::error_code code = json::parse_document(*d, data, length, mode);
+        if (code != json::Ok)
+            throw(json::Exception(json::error_message(code)));
+    }
+
+    void Document::stringify(std::string &content) const noexcept {
+        view().stringify(content);
+    }
+
+    // 所有结点都在arena中, 释放只需重置arena, 与结点数无关
+    void Document::clear() noexcept {
+        if (d == nullptr)
+            return;
+        d->arena.reset();
+        d->root.set_literal(json::Null);
+    }
+
+    DocumentView Document::view() const noexcept {
+        return DocumentView(d ? &d->root : &json::null_node);
+    }
+
+    size_t Document::get_memory_usage() const noexcept {
+        return d ? d->arena.capacity() : 0;
+    }
+
+
+    void DocumentView::stringify(std::string &content) const noexcept {
+        json::Generator(*n, content);
+    }
+
+    int DocumentView::get_type() const noexcept {
+        return n->get_type();
+    }
+
+    double DocumentView::get_number() const noexcept {
+        assert(n->get_type() == json::Number);
+        return n->get_number();
+    }
+
+    int DocumentView::get_number_type() const noexcept {
+        assert(n->get_type() == json::Number);
+        return n->get_number_type();
+    }
+
+    int64_t DocumentView::get_int64() const noexcept {
+        assert(n->get_type() == json::Number);
+        return n->get_int64();
+    }
+
+    uint64_t DocumentView::get_uint64() const noexcept {
+        assert(n->get_type() == json::Number);
+        return n->get_uint64();
+    }
+
+    const char *DocumentView::get_string() const noexcept {
+        assert(n->get_type() == json::String);
+        return n->get_string();
+    }
+
+    size_t DocumentView::get_string_length() const noexcept {
+        assert(n->get_type() == json::String);
+        return n->size();
+    }
+
+    size_t DocumentView::get_array_size() const noexcept {
+        assert(n->get_type() == json::Array);
+        return n->size();
+    }
+
+    DocumentView DocumentView::get_array_element(size_t index) const noexcept {
+        assert(n->get_type() == json::Array && index < n->size());
+        return DocumentView(&n->get_elements()[index]);
+    }
+
+    size_t DocumentView::get_object_size() const noexcept {
+        assert(n->get_type() == json::Object);
+        return n->size();
+    }
+
+    const char *DocumentView::get_object_key(size_t index) const noexcept {
+        assert(n->get_type() == json::Object && index < n->size());
+        return n->get_members()[index].key.get_string();
+    }
+
+    size_t DocumentView::get_object_key_length(size_t index) const noexcept {
+        assert(n->get_type() == json::Object && index < n->size());
+        return n->get_members()[index].key.size();
+    }
+
+    DocumentView DocumentView::get_object_value(size_t index) const noexcept {
+        assert(n->get_type() == json::Object && index < n->size());
+        return DocumentView(&n->get_members()[index].value);
+    }
+
+    long long DocumentView::find_object_index(const std::string &key) const noexcept {
+        assert(n->get_type() == json::Object);
+        const json::Member *members = n->get_members();
+        for (size_t i = 0; i < n->size(); ++i) {
+            const json::Node &k = members[i].key;
+            if (k.size() == key.size() && std::memcmp(k.get_string(), key.data(), key.size()) == 0)
+                return static_cast<long long>(i);
+        }
+        return -1;
+    }
+
+}
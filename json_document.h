@@ -0,0 +1,147 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_document.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明Document使用的结点结构Node与构造结点的DocumentBuilder类;
+  *              结点, 子结点数组与字符串全部分配在Document的Arena中, 不需要逐个析构
+  *Function List:
+  * Node结点(16字节)的布局:
+        前8字节为数值或指向字符串/子结点的指针, 后8字节的低56位为长度或个数, 最高字节为标签;
+        标签的高4位为结点种类, 长字符串标签的最低位记录是否无需转义;
+        长度不超过15的字符串直接存放在结点的前15字节中, 标签为 15-长度, 字符串恰好15字节时
+        标签为0, 兼作结尾的'\0'. 布局依赖小端字节序
+  * DocumentBuilder类主要成员函数功能:
+     1. DocumentBuilder(DocumentData &data);
+            作为Reader的处理器, 把解析结果构造在data.arena中
+     2. void on_xxx(...);
+            完成的值先压入暂存栈; 数组/对象结束时其子结点位于栈顶, 整段拷贝到arena中连续存放,
+            再以一个容器结点替换它们
+  * 其他函数:
+     1. error_code parse_document(DocumentData &data, const char *content, size_t length, parse_mode mode);
+            按mode解析[content, content+length)并返回错误码, 成功后结果存入data.root; 失败时清空arena, 根结点为Null
+     2. void to_value(const Node &node, Value &v) noexcept;
+            把结点及其子树拷贝为Value
+**********************************************************************************/
+
+#ifndef JSON_JSON_DOCUMENT_H
+#define JSON_JSON_DOCUMENT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "json.h"
+#include "json_arena.h"
+#include "json_value.h"
+
+namespace lwy {
+
+    namespace json {
+
+        struct Member;
+
+        class Node final{
+        public:
+            static const size_t max_inline_length = 15;
+
+            int get_type() const noexcept { return kind_types[kind()]; }
+            // json::number_type, 仅对Number结点有意义
+            int get_number_type() const noexcept { return kind() - kind_double; }
+            // 数字按其存储方式解释的8字节内容
+            uint64_t get_bits() const noexcept { return words_[0]; }
+            double get_number() const noexcept;
+            int64_t get_int64() const noexcept;
+            uint64_t get_uint64() const noexcept;
+            // 字符串以'\0'结尾
+            const char *get_string() const noexcept {
+                return kind() == kind_short_string ? reinterpret_cast<const char *>(words_) : pointer<char>();
+            }
+            // 短字符串没有空余的位记录此标志, 总是返回false, 生成器直接扫描这不超过15个字节
+            bool is_escape_free() const noexcept { return tag() == ((kind_string << 4) | 1); }
+            // 字符串长度, 数组元素个数或对象成员个数
+            size_t size() const noexcept {
+                return kind() == kind_short_string ? max_inline_length - tag() : words_[1] & size_mask;
+            }
+            const Node *get_elements() const noexcept { return pointer<Node>(); }
+            const Member *get_members() const noexcept { return pointer<Member>(); }
+
+            void set_literal(json::type t) noexcept;
+            void set_double(double d) noexcept;
+            void set_int64(int64_t i) noexcept { set(kind_int64, static_cast<uint64_t>(i), 0); }
+            void set_uint64(uint64_t u) noexcept { set(kind_uint64, u, 0); }
+            // 短字符串拷贝进结点, 返回false; 长字符串需要调用者把内容拷贝到arena后调用set_long_string
+            bool set_short_string(const char *str, size_t length) noexcept;
+            void set_long_string(const char *str, size_t length, bool escape_free) noexcept;
+            void set_array(const Node *elements, size_t count) noexcept { set_pointer(kind_array, elements, count); }
+            void set_object(const Member *members, size_t count) noexcept { set_pointer(kind_object, members, count); }
+        private:
+            enum : uint8_t {
+                kind_short_string, kind_null, kind_true, kind_false,
+                kind_double, kind_int64, kind_uint64, kind_string, kind_array, kind_object
+            };
+            static const uint64_t size_mask = (uint64_t(1) << 56) - 1;
+            static const int kind_types[16];
+
+            uint8_t tag() const noexcept { return static_cast<uint8_t>(words_[1] >> 56); }
+            uint8_t kind() const noexcept { return tag() >> 4; }
+            template <typename T>
+            const T *pointer() const noexcept { return reinterpret_cast<const T *>(static_cast<uintptr_t>(words_[0])); }
+            void set(uint8_t kind, uint64_t payload, size_t size, uint8_t flags = 0) noexcept {
+                words_[0] = payload;
+                words_[1] = (static_cast<uint64_t>((kind << 4) | flags) << 56) | size;
+            }
+            void set_pointer(uint8_t kind, const void *p, size_t size, uint8_t flags = 0) noexcept {
+                set(kind, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p)), size, flags);
+            }
+
+            uint64_t words_[2];
+        };
+
+        // 对象成员, 键是一个String结点; 暂存栈中相邻的键和值可以直接拷贝为Member数组
+        struct Member {
+            Node key;
+            Node value;
+        };
+
+        struct DocumentData {
+            Arena arena;
+            std::vector<Node> stack;    // 解析时暂存已完成的值, 多次解析间复用其容量
+            Node root;
+        };
+
+        class DocumentBuilder final{
+        public:
+            explicit DocumentBuilder(DocumentData &data) noexcept : arena_(data.arena), stack_(data.stack) { }
+
+            void on_null() { push().set_literal(json::Null); }
+            void on_bool(bool b) { push().set_literal(b ? json::True : json::False); }
+            void on_double(double d) { push().set_double(d); }
+            void on_int64(int64_t i) { push().set_int64(i); }
+            void on_uint64(uint64_t u) { push().set_uint64(u); }
+            void on_string(const char *str, size_t length, bool escape_free);
+            void on_start_array() noexcept { }
+            void on_end_array(size_t count);
+            void on_start_object() noexcept { }
+            void on_key(const char *str, size_t length, bool escape_free) { on_string(str, length, escape_free); }
+            void on_end_object(size_t count);
+        private:
+            Node &push() {
+                stack_.emplace_back();
+                return stack_.back();
+            }
+            // 把栈顶的n个结点移入arena, 返回其在arena中的起始位置
+            const Node *pop_to_arena(size_t n);
+
+            Arena &arena_;
+            std::vector<Node> &stack_;
+        };
+
+        error_code parse_document(DocumentData &data, const char *content, size_t length, parse_mode mode);
+        void to_value(const Node &node, Value &v) noexcept;
+
+    }
+
+}
+
+#endif //JSON_JSON_DOCUMENT_H
@@ -0,0 +1,79 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_file.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现MappedFile类
+**********************************************************************************/
+
+#include "json_file.h"
+
+#if LWY_JSON_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+namespace lwy {
+
+    namespace json {
+
+#if LWY_JSON_MMAP
+        // 映射建立后即可关闭文件描述符, 映射在munmap之前一直有效
+        error_code MappedFile::open(const std::string &path) noexcept {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return json::CannotOpenFile;
+            struct stat st;
+            if (::fstat(fd, &st) != 0) {
+                ::close(fd);
+                return json::CannotOpenFile;
+            }
+            size_t size = static_cast<size_t>(st.st_size);
+            if (size != 0) {
+                void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    ::close(fd);
+                    return json::CannotMapFile;
+                }
+                // 解析器从头到尾读一遍, 让内核加大预读并及早回收读过的页
+                ::madvise(p, size, MADV_SEQUENTIAL);
+                data_ = static_cast<const char *>(p);
+                size_ = size;
+            }
+            ::close(fd);
+            return json::Ok;
+        }
+
+        MappedFile::~MappedFile() noexcept {
+            if (data_ != nullptr)
+                ::munmap(const_cast<char *>(data_), size_);
+        }
+#else
+        error_code MappedFile::open(const std::string &path) noexcept {
+            try {
+                std::ifstream in(path, std::ios::binary);
+                if (!in)
+                    return json::CannotOpenFile;
+                std::ostringstream ss;
+                ss << in.rdbuf();
+                buffer_ = ss.str();
+            } catch (...) {
+                return json::CannotOpenFile;
+            }
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+            return json::Ok;
+        }
+
+        MappedFile::~MappedFile() noexcept = default;
+#endif
+
+    }
+
+}
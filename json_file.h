@@ -0,0 +1,54 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_file.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明MappedFile类, 把文件只读地映射到内存供解析器直接读取, 不经过中间拷贝
+  *Function List:
+  * MappedFile类主要成员函数功能:
+     1. error_code open(const std::string &path) noexcept;
+            打开并映射path, 提示内核按顺序预读; 无法打开或映射时返回CannotOpenFile/CannotMapFile.
+            不支持mmap的平台退化为一次性读入内部缓冲区; 每个对象只应open一次
+     2. const char *data() const noexcept; size_t size() const noexcept;
+            文件内容为[data(), data() + size()), 不以'\0'结尾; 空文件的size()为0
+**********************************************************************************/
+
+#ifndef JSON_JSON_FILE_H
+#define JSON_JSON_FILE_H
+
+#include <cstddef>
+#include <string>
+#include "json.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LWY_JSON_MMAP 1
+#endif
+
+namespace lwy {
+
+    namespace json {
+
+        class MappedFile final{
+        public:
+            MappedFile() noexcept = default;
+            ~MappedFile() noexcept;
+            MappedFile(const MappedFile &rhs) = delete;
+            MappedFile& operator=(const MappedFile &rhs) = delete;
+
+            error_code open(const std::string &path) noexcept;
+            const char *data() const noexcept { return data_; }
+            size_t size() const noexcept { return size_; }
+        private:
+            const char *data_ = nullptr;
+            size_t size_ = 0;
+#if !LWY_JSON_MMAP
+            std::string buffer_;
+#endif
+        };
+
+    }
+
+}
+
+#endif //JSON_JSON_FILE_H
@@ -9,31 +9,49 @@
 
 #include "json_generator.h"
 
+#include <cstring>
+#include "json_number.h"
+#include "json_simd.h"
+
 namespace lwy {
 
     namespace json {
 
         Generator::Generator(const Value &val, std::string &result) : res_(result) {
             res_.clear();
+            // 先遍历一遍算出长度, 大文档只分配一次内存, 避免反复扩容拷贝
+            res_.reserve(measure_value(val));
             stringify_value(val);
         }
 
+        Generator::Generator(const Node &node, std::string &result) : res_(result) {
+            res_.clear();
+            res_.reserve(measure_value(node));
+            stringify_value(node);
+        }
+
+        Generator::Generator(const TapeData &data, size_t index, std::string &result) : res_(result) {
+            res_.clear();
+            res_.reserve(measure_value(data, index));
+            stringify_value(data, index);
+        }
+
         // 递归输出为JSON串
         void Generator::stringify_value(const Value &v) {
             switch (v.get_type()) {
                 case json::Null: res_ += "null";  break;
                 case json::True: res_ += "true";  break;
                 case json::False: res_ += "false"; break;
-                case json::Number: {
-                    // case语句里不能定义局部变量，要用代码块表示
-                    char buffer[32] = {0};
-                    // %g 自动选择合适的表示法, 小数点后17位
-                    sprintf(buffer, "%.17g", v.get_number());
-                    res_ += buffer;
-                }
+                case json::Number:
+                    stringify_number(v.num_type_, v.u64_);
                     break;
                 case json::String:
-                    stringify_string(v.get_string());
+                    if (v.is_escape_free()) {
+                        res_ += '\"';
+                        res_ += v.get_string();
+                        res_ += '\"';
+                    } else
+                        stringify_string(v.get_string().data(), v.get_string().size());
                     break;
                 case json::Array:
                     res_ += '[';
@@ -47,7 +65,7 @@ namespace lwy {
                     res_ += '{';
                     for (size_t i = 0; i < v.get_object_size(); ++i) {
                         if (i > 0) res_ += ',';
-                        stringify_string(v.get_object_key(i));
+                        stringify_string(v.get_object_key(i).data(), v.get_object_key_length(i));
                         res_ += ':';
                         stringify_value(v.get_object_value(i));
                     }
@@ -55,30 +73,242 @@ namespace lwy {
                     break;
             }
         }
-        void Generator::stringify_string(const std::string &str) {
-            res_ += '\"';
-            for(auto it = str.begin(); it < str.end(); ++it) {
-                unsigned char ch = *it;
-                // 遇到如下转义字符和特殊字符也要原样输出
-                switch (ch) {
-                    case '\"': res_ += "\\\""; break;
-                    case '\\': res_ += "\\\\"; break;
-                    case '\b': res_ += "\\b";  break;
-                    case '\f': res_ += "\\f";  break;
-                    case '\n': res_ += "\\n";  break;
-                    case '\r': res_ += "\\r";  break;
-                    case '\t': res_ += "\\t";  break;
-                    default:
-                        // ASCII 字符集中的可打印字符（在十六进制代码 0x20 (32) 和 0x7e (126)之间）
-                        // 第0～32(0x20)号及第127号(共34个)是控制字符或通讯专用字符
-                        if (ch < 0x20 || ch == 0x7f) {
-                            char buffer[7] = {0};
-                            sprintf(buffer, "\\u%04X", ch);
-                            res_ += buffer;
-                        } else
-                            res_ += *it;
+
+        void Generator::stringify_value(const Node &n) {
+            switch (n.get_type()) {
+                case json::Null: res_ += "null";  break;
+                case json::True: res_ += "true";  break;
+                case json::False: res_ += "false"; break;
+                case json::Number:
+                    stringify_number(n.get_number_type(), n.get_bits());
+                    break;
+                case json::String:
+                    if (n.is_escape_free()) {
+                        res_ += '\"';
+                        res_.append(n.get_string(), n.size());
+                        res_ += '\"';
+                    } else
+                        stringify_string(n.get_string(), n.size());
+                    break;
+                case json::Array: {
+                    const Node *elements = n.get_elements();
+                    res_ += '[';
+                    for (size_t i = 0; i < n.size(); ++i) {
+                        if (i > 0) res_ += ',';
+                        stringify_value(elements[i]);
+                    }
+                    res_ += ']';
+                    break;
+                }
+                case json::Object: {
+                    const Member *members = n.get_members();
+                    res_ += '{';
+                    for (size_t i = 0; i < n.size(); ++i) {
+                        if (i > 0) res_ += ',';
+                        stringify_string(members[i].key.get_string(), members[i].key.size());
+                        res_ += ':';
+                        stringify_value(members[i].value);
+                    }
+                    res_ += '}';
+                    break;
+                }
+            }
+        }
+
+        size_t Generator::stringify_value(const TapeData &data, size_t index) {
+            uint64_t word = data.tape[index];
+            switch (tape_tag(word)) {
+                case 'n': res_ += "null"; return index + 1;
+                case 't': res_ += "true"; return index + 1;
+                case 'f': res_ += "false"; return index + 1;
+                case 'd': stringify_number(json::Double, data.tape[index + 1]); return index + 2;
+                case 'l': stringify_number(json::Int64, data.tape[index + 1]); return index + 2;
+                case 'u': stringify_number(json::Uint64, data.tape[index + 1]); return index + 2;
+                case '\"':
+                    if (tape_escape_free_string(data, index)) {
+                        res_ += '\"';
+                        res_.append(tape_string(data, index), tape_string_length(data, index));
+                        res_ += '\"';
+                    } else
+                        stringify_string(tape_string(data, index), tape_string_length(data, index));
+                    return index + 2;
+                case '[': {
+                    size_t end = static_cast<size_t>(tape_payload(word)) - 1;
+                    res_ += '[';
+                    for (size_t i = index + 1; i < end; ) {
+                        if (i > index + 1) res_ += ',';
+                        i = stringify_value(data, i);
+                    }
+                    res_ += ']';
+                    return end + 1;
+                }
+                default: {
+                    size_t end = static_cast<size_t>(tape_payload(word)) - 1;
+                    res_ += '{';
+                    for (size_t i = index + 1; i < end; ) {
+                        if (i > index + 1) res_ += ',';
+                        i = stringify_value(data, i);
+                        res_ += ':';
+                        i = stringify_value(data, i);
+                    }
+                    res_ += '}';
+                    return end + 1;
+                }
+            }
+        }
+
+        // bits为数字按num_type解释的8字节内容
+        void Generator::stringify_number(int num_type, uint64_t bits) {
+            char buffer[32];
+            if (num_type == json::Int64) {
+                res_.append(buffer, write_int64(static_cast<int64_t>(bits), buffer));
+            } else if (num_type == json::Uint64) {
+                res_.append(buffer, write_uint64(bits, buffer));
+            } else {
+                // 能还原原值的最短表示, 定点/科学计数法的选择与 %.17g 相同
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                res_.append(buffer, write_double(d, buffer));
+            }
+        }
+        // 需要转义的字符 ch 输出为 '\\' 加上 escape_table[ch], 'u' 表示输出为 \u00XX
+        // ASCII 字符集中的可打印字符在十六进制代码 0x20 (32) 和 0x7e (126)之间,
+        // 第0～31号及第127号是控制字符或通讯专用字符, 以\u形式输出
+        static const char escape_table[128] = {
+            /* 0x00 */ 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+            /* 0x10 */ 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+            /* 0x20 */ 0, 0, '\"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x30 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x40 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x50 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+            /* 0x60 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x70 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 'u',
+        };
+
+        // 整数的十进制位数
+        static size_t decimal_length(uint64_t u) noexcept {
+            size_t n = 1;
+            for (uint64_t limit = 10; n < 20 && u >= limit; limit *= 10)
+                ++n;
+            return n;
+        }
+
+        size_t Generator::measure_value(const Value &v) noexcept {
+            switch (v.type_) {
+                case json::Null: return 4;
+                case json::True: return 4;
+                case json::False: return 5;
+                case json::Number:
+                    return measure_number(v.num_type_, v.u64_);
+                case json::String:
+                    return v.escape_free_ ? v.str_.size() + 2 : measure_string(v.str_.data(), v.str_.size());
+                case json::Array: {
+                    size_t size = v.arr_.empty() ? 2 : v.arr_.size() + 1;
+                    for (const Value &e : v.arr_)
+                        size += measure_value(e);
+                    return size;
+                }
+                case json::Object: {
+                    // 括号, 逗号与冒号
+                    size_t size = v.obj_.members.empty() ? 2 : 2 * v.obj_.members.size() + 1;
+                    for (const auto &m : v.obj_.members)
+                        size += measure_string(m.first.data(), m.first.size()) + measure_value(m.second);
+                    return size;
+                }
+            }
+            return 0;
+        }
+
+        size_t Generator::measure_value(const Node &n) noexcept {
+            switch (n.get_type()) {
+                case json::Null: return 4;
+                case json::True: return 4;
+                case json::False: return 5;
+                case json::Number:
+                    return measure_number(n.get_number_type(), n.get_bits());
+                case json::String:
+                    return n.is_escape_free() ? n.size() + 2 : measure_string(n.get_string(), n.size());
+                case json::Array: {
+                    const Node *elements = n.get_elements();
+                    size_t size = n.size() ? n.size() + 1 : 2;
+                    for (size_t i = 0; i < n.size(); ++i)
+                        size += measure_value(elements[i]);
+                    return size;
+                }
+                case json::Object: {
+                    const Member *members = n.get_members();
+                    size_t size = n.size() ? 2 * n.size() + 1 : 2;
+                    for (size_t i = 0; i < n.size(); ++i)
+                        size += measure_string(members[i].key.get_string(), members[i].key.size()) +
+                                measure_value(members[i].value);
+                    return size;
                 }
             }
+            return 0;
+        }
+
+        size_t Generator::measure_value(const TapeData &data, size_t index) noexcept {
+            size_t size = 0, end = skip(data, index);
+            while (index < end) {
+                uint64_t word = data.tape[index];
+                switch (tape_tag(word)) {
+                    case 'n': case 't': size += 4; ++index; break;
+                    case 'f': size += 5; ++index; break;
+                    case 'd': size += measure_number(json::Double, data.tape[index + 1]); index += 2; break;
+                    case 'l': size += measure_number(json::Int64, data.tape[index + 1]); index += 2; break;
+                    case 'u': size += measure_number(json::Uint64, data.tape[index + 1]); index += 2; break;
+                    case '\"':
+                        size += tape_escape_free_string(data, index) ? tape_string_length(data, index) + 2 :
+                                measure_string(tape_string(data, index), tape_string_length(data, index));
+                        index += 2;
+                        break;
+                    case '[': case '{': {
+                        // 括号与逗号, 对象另有每个成员的冒号; 键作为字符串在扫描中计入
+                        size_t count = static_cast<size_t>(tape_payload(data.tape[tape_payload(word) - 1]));
+                        size += count == 0 ? 2 : tape_tag(word) == '[' ? count + 1 : 2 * count + 1;
+                        ++index;
+                        break;
+                    }
+                    default: ++index; break;
+                }
+            }
+            return size;
+        }
+
+        size_t Generator::measure_number(int num_type, uint64_t bits) noexcept {
+            if (num_type == json::Int64)
+                return static_cast<int64_t>(bits) < 0 ? 1 + decimal_length(0 - bits) : decimal_length(bits);
+            if (num_type == json::Uint64)
+                return decimal_length(bits);
+            // 最长的形式如 -2.2250738585072014e-308
+            return 24;
+        }
+
+        size_t Generator::measure_string(const char *str, size_t length) noexcept {
+            size_t size = length + 2;
+            const char *p = str, *end = str + length;
+            while ((p = find_string_special(p, end)) != end) {
+                size += escape_table[static_cast<unsigned char>(*p)] == 'u' ? 5 : 1;
+                ++p;
+            }
+            return size;
+        }
+
+        void Generator::stringify_string(const char *str, size_t length) {
+            static const char hex_digits[] = "0123456789ABCDEF";
+            res_ += '\"';
+            const char *p = str, *end = str + length;
+            for (; ;) {
+                // 两个需要转义的字符之间的普通字符整段追加
+                const char *q = find_string_special(p, end);
+                res_.append(p, q);
+                if (q == end)
+                    break;
+                unsigned char ch = *q;
+                char escaped[6] = {'\\', escape_table[ch], '0', '0', hex_digits[ch >> 4], hex_digits[ch & 0xF]};
+                res_.append(escaped, escaped[1] == 'u' ? 6 : 2);
+                p = q + 1;
+            }
             res_ += '\"';
         }
 
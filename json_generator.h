@@ -8,16 +8,30 @@
   *Function List:
   * Generator类主要成员函数功能:
      1. Generator(const Value& val, std::string &result);
-            构造函数,将Value值传入,result 接收返回字符串
+        Generator(const Node& node, std::string &result);
+        Generator(const TapeData& data, size_t index, std::string &result);
+            构造函数,将Value值, Document的结点或磁带上index处的值传入,result 接收返回字符串;
+            输出前先由measure_value算出长度并一次性reserve
      2. void stringify_value(const Value &v);
-            将v对应的值序列化为字符串, 存入成员变量res_
-     3. void stringify_string(const std::string &str);
-            处理str对应的字符串,包括将转移字符过滤转化等
+        void stringify_value(const Node &n);
+        size_t stringify_value(const TapeData &data, size_t index);
+            将v对应的值序列化为字符串, 存入成员变量res_; 磁带版本返回该值之后的位置
+     3. void stringify_string(const char *str, size_t length);
+            处理str对应的字符串,包括将转移字符过滤转化等; 需要转义的字符由find_string_special定位,
+            其间的普通字符整段追加, 已知无需转义(Value::is_escape_free)的字符串直接整体拷贝
+     4. static size_t measure_value(const Value &v) noexcept;
+        static size_t measure_value(const Node &n) noexcept;
+        static size_t measure_value(const TapeData &data, size_t index) noexcept;
+        static size_t measure_string(const char *str, size_t length) noexcept;
+            计算序列化结果的长度, 除double按最长的24字节计算外都是精确值, 因此是输出长度的上界;
+            磁带版本顺序扫描该值所占的一段磁带, 不需要递归
 **********************************************************************************/
 
 #ifndef JSON_JSON_GENERATOR_H
 #define JSON_JSON_GENERATOR_H
 
+#include "json_document.h"
+#include "json_tape.h"
 #include "json_value.h"
 
 namespace lwy {
@@ -27,9 +41,19 @@ namespace lwy {
         class Generator final{
         public:
             Generator(const Value& val, std::string &result);
+            Generator(const Node& node, std::string &result);
+            Generator(const TapeData& data, size_t index, std::string &result);
         private:
             void stringify_value(const Value &v);
-            void stringify_string(const std::string &str);
+            void stringify_value(const Node &n);
+            size_t stringify_value(const TapeData &data, size_t index);
+            void stringify_number(int num_type, uint64_t bits);
+            void stringify_string(const char *str, size_t length);
+            static size_t measure_value(const Value &v) noexcept;
+            static size_t measure_value(const Node &n) noexcept;
+            static size_t measure_value(const TapeData &data, size_t index) noexcept;
+            static size_t measure_number(int num_type, uint64_t bits) noexcept;
+            static size_t measure_string(const char *str, size_t length) noexcept;
 
             std::string &res_;
         };
@@ -0,0 +1,349 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_lazy.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现按需解析的扫描函数与LazyJson类
+**********************************************************************************/
+
+#include "json_lazy.h"
+
+#include <cassert>
+#include <cstring>
+#include "json_exception.h"
+#include "json_parser.h"
+#include "json_reader.h"
+#include "json_simd.h"
+#include "json_validator.h"
+
+namespace lwy {
+
+    namespace json {
+
+        // p为开引号之后的位置, 返回闭引号之后的位置
+        static const char *skip_string(const char *p, const char *end) noexcept {
+            for (;;) {
+                p = find_string_special(p, end);
+                if (p == end)
+                    return nullptr;
+                if (*p == '\"')
+                    return p + 1;
+                if (*p == '\\' && ++p == end)
+                    return nullptr;
+                ++p;
+            }
+        }
+
+        // p为开括号之后的位置, 返回配对的闭括号之后的位置; '['与'{'只差0x20位, 按位或0x20后一起比较
+        static const char *skip_container(const char *p, const char *end) noexcept {
+            size_t depth = 1;
+#if LWY_JSON_SSE2
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i open = _mm_set1_epi8('{');
+            const __m128i close = _mm_set1_epi8('}');
+            const __m128i fold = _mm_set1_epi8(0x20);
+            while (end - p >= 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                __m128i folded = _mm_or_si128(chunk, fold);
+                unsigned opens = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, open)));
+                unsigned closes = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, close)));
+                unsigned quotes = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)));
+                unsigned mask = opens | closes | quotes;
+                const char *next = p + 16;
+                // 依次处理块内的括号, 遇到引号时越过整个字符串, 从其后重新加载
+                while (mask != 0) {
+                    unsigned bit = mask & (0u - mask);
+                    const char *q = p + trailing_zeros(mask);
+                    if (bit & quotes) {
+                        next = skip_string(q + 1, end);
+                        if (next == nullptr)
+                            return nullptr;
+                        break;
+                    }
+                    if (bit & opens)
+                        ++depth;
+                    else if (--depth == 0)
+                        return q + 1;
+                    mask ^= bit;
+                }
+                p = next;
+            }
+#endif
+            while (p != end) {
+                char ch = *p++;
+                if (ch == '\"') {
+                    p = skip_string(p, end);
+                    if (p == nullptr)
+                        return nullptr;
+                } else if ((ch | 0x20) == '{') {
+                    ++depth;
+                } else if ((ch | 0x20) == '}' && --depth == 0) {
+                    return p;
+                }
+            }
+            return nullptr;
+        }
+
+        const char *skip_value(const char *p, const char *end) noexcept {
+            if (p == end)
+                return nullptr;
+            switch (*p) {
+                case '\"': return skip_string(p + 1, end);
+                case '[' :
+                case '{' : return skip_container(p + 1, end);
+                default  : {
+                    const char *q = p;
+                    while (q != end && *q != ',' && *q != ']' && *q != '}' && !is_whitespace(*q))
+                        ++q;
+                    return q != p ? q : nullptr;
+                }
+            }
+        }
+
+        error_code check_value(const char *p, const char *end) {
+            Validator validator;
+            Reader<Validator, false> reader(validator, p, end);
+            return reader.parse_scalar_at(p) != nullptr ? json::Ok : reader.get_error();
+        }
+
+        error_code parse_value_at(const char *p, const char *end, Value &val) {
+            val.set_type(json::Null);
+            Parser parser(val);
+            Reader<Parser> reader(parser, p, end);
+            if (reader.parse_scalar_at(p) != nullptr)
+                return json::Ok;
+            val.set_type(json::Null);
+            return reader.get_error();
+        }
+
+        [[noreturn]] static void raise(error_code code) {
+            throw(json::Exception(error_message(code)));
+        }
+
+        // 越过p处的值, 越不过去时由Reader给出准确的错误
+        static const char *skip_or_raise(const char *p, const char *end) {
+            const char *q = skip_value(p, end);
+            if (q == nullptr) {
+                error_code code = check_value(p, end);
+                assert(code != json::Ok);
+                raise(code);
+            }
+            return q;
+        }
+
+        // 只接收键的处理器, 键在Reader析构后失效, 因此在回调中就地比较或拷贝
+        class KeySkipper final{
+        public:
+            void on_key(const char *, size_t, bool) noexcept { }
+        };
+
+        // FNV-1a, 只用来排除不可能相等的键, 哈希相等时仍比较键本身
+        static uint64_t hash_key(const char *str, size_t length) noexcept {
+            uint64_t hash = 14695981039346656037ULL;
+            for (size_t i = 0; i < length; ++i)
+                hash = (hash ^ static_cast<unsigned char>(str[i])) * 1099511628211ULL;
+            return hash;
+        }
+
+        class KeyMatcher final{
+        public:
+            explicit KeyMatcher(const std::string &key) noexcept : key_(key) { }
+            void on_key(const char *str, size_t length, bool) noexcept {
+                matched = length == key_.size() && std::memcmp(str, key_.data(), length) == 0;
+                hash = hash_key(str, length);
+            }
+            bool matched = false;
+            uint64_t hash = 0;
+        private:
+            const std::string &key_;
+        };
+
+        class KeyCopier final{
+        public:
+            explicit KeyCopier(std::string &key) noexcept : key_(key) { }
+            void on_key(const char *str, size_t length, bool) { key_.assign(str, length); }
+        private:
+            std::string &key_;
+        };
+
+        // 解析m处成员的键交给handler, 返回值的开始位置
+        template <typename Handler>
+        static const char *parse_member_key(const char *m, const char *end, Handler &handler) {
+            Reader<Handler> reader(handler, m, end);
+            const char *q = reader.parse_key_at(m);
+            if (q == nullptr)
+                raise(json::MissKey);
+            q = skip_whitespace(q, end);
+            if (q == end || *q != ':')
+                raise(json::MissColon);
+            return skip_whitespace(q + 1, end);
+        }
+
+    }
+
+    LazyJson LazyJson::make(const char *value, const char *end) {
+        if (value == end)
+            json::raise(json::ExpectValue);
+        return LazyJson(value, end);
+    }
+
+    bool LazyJson::closes(const char *member) const noexcept {
+        return member != e && *member == (*p == '[' ? ']' : '}');
+    }
+
+    const char *LazyJson::first_member() const {
+        const char *q = json::skip_whitespace(p + 1, e);
+        if (*p == '{' && !closes(q) && (q == e || *q != '\"'))
+            json::raise(json::MissKey);
+        return q;
+    }
+
+    // value为当前成员的值, 返回下一个成员或闭括号的位置; 逗号之后的检查与Reader相同
+    const char *LazyJson::next_member(const char *value) const {
+        const char *q = json::skip_whitespace(json::skip_or_raise(value, e), e);
+        if (q != e && *q == ',') {
+            q = json::skip_whitespace(q + 1, e);
+            if (*p == '{' && (q == e || *q != '\"'))
+                json::raise(json::MissKey);
+            if (closes(q))
+                json::raise(json::check_value(q, e));
+            return q;
+        }
+        if (!closes(q))
+            json::raise(*p == '[' ? json::MissCommaOrSquareBracket : json::MissCommaOrCurlyBracket);
+        return q;
+    }
+
+    // 从光标处向后走到第index个成员, 要找的成员在光标之前时从头开始; 成员不足时停在闭括号处
+    const char *LazyJson::seek(size_t index) const {
+        if (cur == nullptr || index < cur_index) {
+            cur = first_member();
+            cur_index = 0;
+        }
+        while (cur_index < index && !closes(cur)) {
+            const char *value = cur;
+            if (*p == '{') {
+                json::KeySkipper skipper;
+                value = json::parse_member_key(cur, e, skipper);
+            }
+            cur = next_member(value);
+            ++cur_index;
+        }
+        return cur;
+    }
+
+    // 下标越界时抛出Exception, 而不是把闭括号当作成员
+    const char *LazyJson::member(size_t index) const {
+        const char *m = seek(index);
+        if (closes(m)) {
+            count = cur_index;
+            throw(json::Exception("lazy index out of range"));
+        }
+        return m;
+    }
+
+    // 容器的成员数在第一次查询时数出, 之后直接返回
+    size_t LazyJson::count_members() const {
+        if (count == npos) {
+            size_t n = cur != nullptr ? cur_index : 0;
+            const char *q = seek(n);
+            while (!closes(q)) {
+                const char *value = q;
+                if (*p == '{') {
+                    json::KeySkipper skipper;
+                    value = json::parse_member_key(q, e, skipper);
+                }
+                q = next_member(value);
+                ++n;
+            }
+            count = n;
+        }
+        return count;
+    }
+
+    int LazyJson::get_type() const {
+        if (*p == '[')
+            return json::Array;
+        if (*p == '{')
+            return json::Object;
+        return Json(*this).get_type();
+    }
+
+    double LazyJson::get_number() const {
+        return Json(*this).get_number();
+    }
+
+    int LazyJson::get_number_type() const {
+        return Json(*this).get_number_type();
+    }
+
+    int64_t LazyJson::get_int64() const {
+        return Json(*this).get_int64();
+    }
+
+    uint64_t LazyJson::get_uint64() const {
+        return Json(*this).get_uint64();
+    }
+
+    std::string LazyJson::get_string() const {
+        return Json(*this).get_string();
+    }
+
+    size_t LazyJson::get_array_size() const {
+        assert(*p == '[');
+        return count_members();
+    }
+
+    LazyJson LazyJson::get_array_element(size_t index) const {
+        assert(*p == '[');
+        return make(member(index), e);
+    }
+
+    size_t LazyJson::get_object_size() const {
+        assert(*p == '{');
+        return count_members();
+    }
+
+    std::string LazyJson::get_object_key(size_t index) const {
+        assert(*p == '{');
+        std::string key;
+        json::KeyCopier copier(key);
+        json::parse_member_key(member(index), e, copier);
+        return key;
+    }
+
+    LazyJson LazyJson::get_object_value(size_t index) const {
+        assert(*p == '{');
+        json::KeySkipper skipper;
+        return make(json::parse_member_key(member(index), e, skipper), e);
+    }
+
+    // 查找经过的键都记下哈希; 光标之前(且已记下哈希)的键中没有同样的哈希时, 键第一次出现一定在光标之后,
+    // 从光标处向后找即可, 否则从第一个哈希相同的成员开始. 按字段顺序依次查找时每个成员只扫描一次
+    long long LazyJson::find_object_index(const std::string &key) const {
+        assert(*p == '{');
+        uint64_t hash = json::hash_key(key.data(), key.size());
+        size_t start = cur != nullptr && cur_index < key_hashes.size() ? cur_index : key_hashes.size();
+        for (size_t i = 0; i < start; ++i) {
+            if (key_hashes[i] == hash) {
+                start = i;
+                break;
+            }
+        }
+        seek(start);
+        while (!closes(cur)) {
+            json::KeyMatcher matcher(key);
+            const char *value = json::parse_member_key(cur, e, matcher);
+            if (cur_index == key_hashes.size())
+                key_hashes.push_back(matcher.hash);
+            if (matcher.matched)
+                return static_cast<long long>(cur_index);
+            cur = next_member(value);
+            ++cur_index;
+        }
+        count = cur_index;
+        return -1;
+    }
+
+}
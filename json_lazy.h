@@ -0,0 +1,38 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_lazy.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明按需解析(LazyJson)用到的扫描函数: 不需要的值只按括号与引号配对整段越过,
+  *              不检查内部的语法; 需要的值仍交给Reader, 与Json::parse报告相同的错误
+  *Function List:
+     1. const char *skip_value(const char *p, const char *end) noexcept;
+            越过p处的一个值, 返回其后的位置. 字符串只找结尾的引号, 数组与对象只数括号的层数(引号内的
+            括号不计), 用SSE2每次检查16字节; 字面值与数字越过到下一个',', ']', '}'或空白符为止.
+            引号或括号到末尾仍不配对, 或p处没有值时返回nullptr, 此时用check_value得到准确的错误
+     2. error_code check_value(const char *p, const char *end);
+            按Json::parse的语法检查p处的一个值(含其全部子结点), 不构造结果, 返回错误码
+     3. error_code parse_value_at(const char *p, const char *end, Value &val);
+            把p处的一个值及其子树解析到val中, 出错时val为Null; 值之后的内容不检查
+**********************************************************************************/
+
+#ifndef JSON_JSON_LAZY_H
+#define JSON_JSON_LAZY_H
+
+#include "json.h"
+#include "json_value.h"
+
+namespace lwy {
+
+    namespace json {
+
+        const char *skip_value(const char *p, const char *end) noexcept;
+        error_code check_value(const char *p, const char *end);
+        error_code parse_value_at(const char *p, const char *end, Value &val);
+
+    }
+
+}
+
+#endif //JSON_JSON_LAZY_H
@@ -0,0 +1,83 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_ndjson.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现NdjsonReader类
+**********************************************************************************/
+
+#include "json.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include "json_simd.h"
+#include "json_thread_pool.h"
+
+namespace lwy {
+
+    namespace json {
+
+        // 每个任务至少包含的字节数, 过小的任务调度开销占比太大
+        static const size_t min_batch_bytes = 16 * 1024;
+
+        struct LineSpan {
+            size_t begin;
+            size_t end;
+            size_t line;
+        };
+
+    }
+
+
+    NdjsonReader::NdjsonReader(size_t threads) {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        pool.reset(new json::ThreadPool(threads));
+    }
+
+    NdjsonReader::~NdjsonReader() noexcept = default;
+
+    size_t NdjsonReader::get_thread_count() const noexcept {
+        return pool->size();
+    }
+
+    // 合法的JSON字符串中不能出现未转义的换行, 因此每个'\n'都是行的边界;
+    // 字符串中的裸换行本来就是错误, 按行切分让错误只影响所在的两行
+    void NdjsonReader::parse(const std::string &content, std::vector<JsonLine> &results) {
+        std::vector<json::LineSpan> lines;
+        const char *data = content.data(), *end = data + content.size();
+        size_t line = 1;
+        for (const char *p = data; p < end; ++line) {
+            const char *q = static_cast<const char *>(std::memchr(p, '\n', end - p));
+            if (q == nullptr)
+                q = end;
+            if (json::skip_whitespace(p, q) != q)
+                lines.push_back(json::LineSpan{static_cast<size_t>(p - data), static_cast<size_t>(q - data), line});
+            p = q + 1;
+        }
+
+        // 相邻的行合成一个任务, 任务数为线程数的若干倍, 由线程池动态分配
+        std::vector<size_t> batches;
+        size_t batch_bytes = std::max(json::min_batch_bytes, content.size() / (pool->size() * 8) + 1);
+        for (size_t i = 0, bytes = batch_bytes; i < lines.size(); ++i) {
+            if (bytes >= batch_bytes) {
+                batches.push_back(i);
+                bytes = 0;
+            }
+            bytes += lines[i].end - lines[i].begin + 1;
+        }
+        batches.push_back(lines.size());
+
+        results.clear();
+        results.resize(lines.size());
+        pool->run(batches.size() - 1, [&](size_t b) {
+            for (size_t i = batches[b]; i < batches[b + 1]; ++i) {
+                results[i].value.parse(data + lines[i].begin, lines[i].end - lines[i].begin, results[i].status);
+                results[i].line = lines[i].line;
+            }
+        });
+    }
+
+}
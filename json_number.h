@@ -0,0 +1,63 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_number.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明数字与文本之间的转换函数, 不依赖全局C locale
+  *Function List:
+     1. bool compute_double(uint64_t w, int64_t q, bool negative, bool truncated, double &d) noexcept;
+            计算最接近 (-1)^negative * w * 10^q 的double; w不超过19位十进制数,
+            truncated表示原文的有效数字多于19位而被截断; 无法确定正确舍入时返回false
+     2. double parse_double_slow(const char *begin, const char *end);
+            精确但较慢的转换, 仅在compute_double返回false时使用
+     3. char *write_uint64(uint64_t u, char *buffer) noexcept;
+        char *write_int64(int64_t i, char *buffer) noexcept;
+            把整数的十进制表示写入buffer(至少20/21字节), 返回写入的末尾位置, 不写'\0'
+     4. char *write_double(double d, char *buffer) noexcept;
+            以能精确还原d的最短十进制数字(Ryu算法)写入buffer(至少32字节), 返回写入的末尾位置;
+            选择定点/科学计数法的规则与printf的%.17g相同, 如 0.1, 1e+20, 5e-324
+     5. int64_t double_to_int64(double d) noexcept;
+        uint64_t double_to_uint64(double d) noexcept;
+            截断d的小数部分转换为整数; 超出范围时取最近的边界值, NaN为0(直接static_cast是未定义行为)
+**********************************************************************************/
+
+#ifndef JSON_JSON_NUMBER_H
+#define JSON_JSON_NUMBER_H
+
+#include <cstdint>
+
+namespace lwy {
+
+    namespace json {
+
+        bool compute_double(uint64_t w, int64_t q, bool negative, bool truncated, double &d) noexcept;
+        double parse_double_slow(const char *begin, const char *end);
+        char *write_uint64(uint64_t u, char *buffer) noexcept;
+        char *write_int64(int64_t i, char *buffer) noexcept;
+        char *write_double(double d, char *buffer) noexcept;
+
+        inline int64_t double_to_int64(double d) noexcept {
+            if (d != d)
+                return 0;
+            if (d >= 9223372036854775808.0)
+                return INT64_MAX;
+            if (d <= -9223372036854775808.0)
+                return INT64_MIN;
+            return static_cast<int64_t>(d);
+        }
+
+        // 不大于-1的数与NaN都为0, (-1, 0)截断后为0
+        inline uint64_t double_to_uint64(double d) noexcept {
+            if (!(d > -1.0))
+                return 0;
+            if (d >= 18446744073709551616.0)
+                return UINT64_MAX;
+            return static_cast<uint64_t>(d);
+        }
+
+    }
+
+}
+
+#endif //JSON_JSON_NUMBER_H
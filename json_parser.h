@@ -4,36 +4,24 @@
   *Author:  lwy
   *Version:  1.3
   *Date:  2022-03-23
-  *Description:  此文件声明Json解析器类Parser, 用于解析JSON串中的各种符号
+  *Description:  此文件声明Json解析器类Parser, 语法分析由Reader完成, Parser作为其处理器把各个值
+  *              构造为Value树
   *Function List:
   * Parser类主要成员函数功能:
-     1. Parser(Value &val, const std::string &content);
-            构造函数, 传入Value初始化成员变量val_, 将解析的C++对象放入val
-     2. void parse_whitespace() noexcept;
-            解析空白符号: 空格, 制表符, 换行, 回车, 解析完这类字符会移动当前解析的指针位置cur
-     3. void parse_value();
-            解析各种类型值的分发入口,通过遇到的第一个字符来判断要解析的值类型
-     4. void parse_literal(const char *literal, json::type t);
-            解析字面值: Null, True, False
-     5. void parse_number();
-            解析double类型数字
-     6. void parse_string();
-            解析普通字符串
-     7. void parse_string_raw(std::string &tmp);
-            解析原始字符串
-     8. void parse_hex4(const char* &p, unsigned &u);
-            解析16进制数字
-     9. void parse_encode_utf8(std::string &s, unsigned u) const noexcept;
-            解析utf8编码字符
-     10. void parse_array();
-            解析数组类型
-     11. void parse_object();
-            递归解析JSON对象
+     1. explicit Parser(Value &val) noexcept;
+            结果构造在val中; 可以只作为处理器使用, 事件由调用者(如PushParser)驱动
+        error_code parse(const char *begin, const char *end, parse_mode mode, size_t &offset);
+            按mode解析[begin, end)并构造到val中, 返回错误码, 出错时offset为出错处的字节偏移且val被置为Null
+     2. Value &next_value();
+            返回下一个值应当存放的位置: 根结点, 当前数组末尾新构造的元素, 或当前对象最后一个成员的值
+     3. void on_xxx(...);
+            Reader的事件回调, 子结点在父结点的数组/对象中就地构造, 整棵树中每个结点只构造一次
 **********************************************************************************/
 
 #ifndef JSON_JSON_PARSER_H
 #define JSON_JSON_PARSER_H
 
+#include <vector>
 #include "json.h"
 #include "json_value.h"
 
@@ -43,21 +31,29 @@ namespace lwy {
 
         class Parser final{
         public:
-            Parser(Value &val, const std::string &content);
+            explicit Parser(Value &val) noexcept : root_(val) { }
+            error_code parse(const char *begin, const char *end, parse_mode mode, size_t &offset);
+
+            void on_null() noexcept { next_value().set_type(json::Null); }
+            void on_bool(bool b) noexcept { next_value().set_type(b ? json::True : json::False); }
+            void on_double(double d) noexcept { next_value().set_number(d); }
+            void on_int64(int64_t i) noexcept { next_value().set_int64(i); }
+            void on_uint64(uint64_t u) noexcept { next_value().set_uint64(u); }
+            void on_string(const char *str, size_t length, bool escape_free);
+            void on_start_array();
+            void on_end_array(size_t) noexcept { stack_.pop_back(); }
+            void on_start_object();
+            void on_key(const char *str, size_t length, bool escape_free);
+            void on_end_object(size_t) noexcept {
+                stack_.back()->index_object();
+                stack_.pop_back();
+            }
         private:
-            void parse_whitespace() noexcept;
-            void parse_value();
-            void parse_literal(const char *literal, json::type t);
-            void parse_number();
-            void parse_string();
-            void parse_string_raw(std::string &tmp);
-            void parse_hex4(const char* &p, unsigned &u);
-            void parse_encode_utf8(std::string &s, unsigned u) const noexcept;
-            void parse_array();
-            void parse_object();
+            Value &next_value();
 
-            Value &val_;
-            const char *cur_;
+            Value &root_;
+            // 尚未结束的数组/对象; 子结点构造期间父结点的容器不会增长, 指针保持有效
+            std::vector<Value *> stack_;
         };
 
     }
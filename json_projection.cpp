@@ -0,0 +1,340 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_projection.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现JSON Pointer路径的编译与投影解析
+**********************************************************************************/
+
+#include "json_projection.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include "json_exception.h"
+#include "json_lazy.h"
+#include "json_parser.h"
+#include "json_reader.h"
+#include "json_simd.h"
+#include "json_validator.h"
+
+namespace lwy {
+
+    namespace json {
+
+        constexpr size_t ProjectionState::npos;
+
+        // 路径的前缀树, "*"段与其他段一样按名字存放
+        struct PathNode {
+            bool selected = false;
+            std::vector<std::pair<std::string, size_t>> children;
+        };
+
+        static void split_pointer(const std::string &path, std::vector<std::string> &segments) {
+            segments.clear();
+            if (path.empty())
+                return;     // 空路径表示整个文档
+            if (path[0] != '/')
+                throw(json::Exception("projection invalid json pointer"));
+            for (size_t i = 0; i < path.size(); ) {
+                std::string segment;
+                for (++i; i < path.size() && path[i] != '/'; ++i) {
+                    if (path[i] != '~') {
+                        segment += path[i];
+                    } else if (i + 1 < path.size() && (path[i + 1] == '0' || path[i + 1] == '1')) {
+                        segment += path[++i] == '0' ? '~' : '/';
+                    } else {
+                        throw(json::Exception("projection invalid json pointer"));
+                    }
+                }
+                segments.push_back(std::move(segment));
+            }
+        }
+
+        void compile_projection(const std::vector<std::string> &paths, ProjectionData &data) {
+            std::vector<PathNode> nodes(1);
+            std::vector<std::string> segments;
+            for (const std::string &path : paths) {
+                split_pointer(path, segments);
+                size_t node = 0;
+                for (std::string &segment : segments) {
+                    size_t next = 0;
+                    for (const auto &child : nodes[node].children) {
+                        if (child.first == segment)
+                            next = child.second;
+                    }
+                    if (next == 0) {
+                        next = nodes.size();
+                        nodes.emplace_back();
+                        nodes[node].children.emplace_back(std::move(segment), next);
+                    }
+                    node = next;
+                }
+                nodes[node].selected = true;
+            }
+
+            // 子集构造: 每个状态是一组前缀树结点, 具体的键同时走到同名结点与"*"结点
+            data.states.clear();
+            std::map<std::vector<size_t>, size_t> ids;
+            std::vector<std::vector<size_t>> sets;
+            auto state_of = [&](std::vector<size_t> set) -> size_t {
+                std::sort(set.begin(), set.end());
+                set.erase(std::unique(set.begin(), set.end()), set.end());
+                auto it = ids.find(set);
+                if (it != ids.end())
+                    return it->second;
+                size_t id = data.states.size();
+                data.states.emplace_back();
+                for (size_t node : set)
+                    data.states[id].selected = data.states[id].selected || nodes[node].selected;
+                ids.emplace(set, id);
+                sets.push_back(std::move(set));
+                return id;
+            };
+            state_of(std::vector<size_t>{0});
+            for (size_t id = 0; id < sets.size(); ++id) {
+                if (data.states[id].selected)
+                    continue;   // 整棵子树都要, 不再细分
+                std::vector<size_t> wildcard;
+                std::set<std::string> keys;
+                for (size_t node : sets[id]) {
+                    for (const auto &child : nodes[node].children) {
+                        if (child.first == "*")
+                            wildcard.push_back(child.second);
+                        else
+                            keys.insert(child.first);
+                    }
+                }
+                for (const std::string &key : keys) {
+                    std::vector<size_t> next = wildcard;
+                    for (size_t node : sets[id]) {
+                        for (const auto &child : nodes[node].children) {
+                            if (child.first == key)
+                                next.push_back(child.second);
+                        }
+                    }
+                    size_t target = state_of(std::move(next));
+                    data.states[id].edges.emplace_back(key, target);
+                }
+                if (!wildcard.empty()) {
+                    size_t target = state_of(std::move(wildcard));
+                    data.states[id].other = target;
+                }
+            }
+        }
+
+        // 只接收键的处理器; 键指向输入或Reader的解码缓冲区, 在下一个键解析之前有效
+        class KeyCapture final{
+        public:
+            void on_key(const char *str, size_t length, bool) noexcept {
+                key = str;
+                key_length = length;
+            }
+
+            const char *key = nullptr;
+            size_t key_length = 0;
+        };
+
+        // 沿状态机遍历文档; 不构造的部分与Json::parse使用同一个Reader检查, 因此报告相同的错误与位置
+        class Projector final{
+        public:
+            Projector(const ProjectionData &data, const char *begin, const char *end, parse_mode mode) noexcept
+                    : data_(data), begin_(begin), end_(end), check_utf8_(!(mode & json::TrustedUtf8)),
+                      check_skipped_(!(mode & json::UncheckedSkip)), stop_when_found_(mode & json::StopWhenFound),
+                      checker_(validator_, begin, end, check_utf8_), keys_(capture_, begin, end, check_utf8_) { }
+            error_code parse(Value &root);
+            size_t get_error_offset() const noexcept { return error_pos_ - begin_; }
+        private:
+            char at(const char *p) const noexcept { return p != end_ ? *p : '\0'; }
+            const char *fail(error_code code, const char *p) noexcept {
+                error_ = code;
+                error_pos_ = p;
+                return nullptr;
+            }
+            // 选中的值, 或可以继续沿路径向下的容器
+            bool descends(size_t state, const char *p) const noexcept {
+                return data_.states[state].selected || at(p) == '{' || at(p) == '[';
+            }
+            size_t find_edge(const ProjectionState &s, const char *key, size_t length) const noexcept;
+            const char *project(const char *p, size_t state, Value &val);
+            const char *project_object(const char *p, const ProjectionState &s, Value &val);
+            const char *project_array(const char *p, const ProjectionState &s, Value &val);
+            const char *materialize(const char *p, Value &val);
+            const char *skip(const char *p);
+
+            const ProjectionData &data_;
+            const char *begin_;
+            const char *end_;
+            bool check_utf8_;
+            bool check_skipped_;
+            bool stop_when_found_;
+            bool stopped_ = false;      // 已找到全部的键, 没有读完文档就结束
+            Validator validator_;
+            Reader<Validator, false> checker_;
+            KeyCapture capture_;
+            Reader<KeyCapture> keys_;
+            error_code error_ = json::Ok;
+            const char *error_pos_ = nullptr;
+        };
+
+        error_code Projector::parse(Value &root) {
+            root.set_type(json::Null);
+            const char *p = skip_whitespace(begin_, end_);
+            p = descends(0, p) ? project(p, 0, root) : skip(p);
+            if (stopped_)
+                return json::Ok;
+            if (p != nullptr && skip_whitespace(p, end_) != end_)
+                p = fail(json::RootNotSingular, skip_whitespace(p, end_));
+            if (p == nullptr) {
+                root.set_type(json::Null);
+                return error_;
+            }
+            return json::Ok;
+        }
+
+        // 在有序的edges中二分查找, 键不拷贝; 返回边的下标, 没有时返回npos
+        size_t Projector::find_edge(const ProjectionState &s, const char *key, size_t length) const noexcept {
+            size_t low = 0, high = s.edges.size();
+            while (low < high) {
+                size_t mid = low + (high - low) / 2;
+                int cmp = s.edges[mid].first.compare(0, std::string::npos, key, length);
+                if (cmp == 0)
+                    return mid;
+                if (cmp < 0)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+            return ProjectionState::npos;
+        }
+
+        const char *Projector::project(const char *p, size_t state, Value &val) {
+            const ProjectionState &s = data_.states[state];
+            if (s.selected)
+                return materialize(p, val);
+            if (*p == '[')
+                return project_array(p, s, val);
+            const char *q = project_object(p, s, val);
+            if (q != nullptr)
+                val.index_object();
+            return q;
+        }
+
+        // 逗号, 冒号与括号的检查与Reader::parse_object相同
+        // StopWhenFound: 根对象中每个有边的键都处理过一次后, 其余成员不会再被选中, 不必读完
+        const char *Projector::project_object(const char *p, const ProjectionState &s, Value &val) {
+            val.set_object(std::vector<std::pair<std::string, Value>>{});
+            std::vector<char> found;
+            size_t remaining = 0;
+            if (stop_when_found_ && &s == &data_.states[0] && s.other == ProjectionState::npos) {
+                found.resize(s.edges.size());
+                remaining = s.edges.size();
+            }
+            p = skip_whitespace(p + 1, end_);
+            if (at(p) == '}')
+                return p + 1;
+            for (;;) {
+                if (at(p) != '\"')
+                    return fail(json::MissKey, p);
+                const char *q = keys_.parse_key_at(p);
+                if (q == nullptr)
+                    return fail(json::MissKey, p);
+                q = skip_whitespace(q, end_);
+                if (at(q) != ':')
+                    return fail(json::MissColon, q);
+                q = skip_whitespace(q + 1, end_);
+                size_t edge = find_edge(s, capture_.key, capture_.key_length);
+                size_t next = edge != ProjectionState::npos ? s.edges[edge].second : s.other;
+                if (next != ProjectionState::npos && descends(next, q)) {
+                    val.obj_.members.emplace_back(std::string(capture_.key, capture_.key_length), Value());
+                    q = project(q, next, val.obj_.members.back().second);
+                } else {
+                    q = skip(q);
+                }
+                if (q == nullptr)
+                    return nullptr;
+                if (remaining != 0 && edge != ProjectionState::npos && !found[edge]) {
+                    found[edge] = 1;
+                    if (--remaining == 0) {
+                        stopped_ = true;
+                        return q;
+                    }
+                }
+                q = skip_whitespace(q, end_);
+                if (at(q) == ',')
+                    p = skip_whitespace(q + 1, end_);
+                else if (at(q) == '}')
+                    return q + 1;
+                else
+                    return fail(json::MissCommaOrCurlyBracket, q);
+            }
+        }
+
+        // 数组中只保留走上路径的元素, 按原来的顺序
+        const char *Projector::project_array(const char *p, const ProjectionState &s, Value &val) {
+            val.set_array(std::vector<Value>{});
+            p = skip_whitespace(p + 1, end_);
+            if (at(p) == ']')
+                return p + 1;
+            for (size_t index = 0; ; ++index) {
+                size_t next = s.other;
+                if (!s.edges.empty()) {
+                    std::string key = std::to_string(index);
+                    size_t edge = find_edge(s, key.data(), key.size());
+                    if (edge != ProjectionState::npos)
+                        next = s.edges[edge].second;
+                }
+                const char *q;
+                if (next != ProjectionState::npos && descends(next, p)) {
+                    val.arr_.emplace_back();
+                    q = project(p, next, val.arr_.back());
+                } else {
+                    q = skip(p);
+                }
+                if (q == nullptr)
+                    return nullptr;
+                q = skip_whitespace(q, end_);
+                if (at(q) == ',')
+                    p = skip_whitespace(q + 1, end_);
+                else if (at(q) == ']')
+                    return q + 1;
+                else
+                    return fail(json::MissCommaOrSquareBracket, q);
+            }
+        }
+
+        const char *Projector::materialize(const char *p, Value &val) {
+            Parser parser(val);
+            Reader<Parser> reader(parser, begin_, end_, check_utf8_);
+            const char *q = reader.parse_scalar_at(p);
+            if (q == nullptr)
+                fail(reader.get_error(), begin_ + reader.get_error_offset());
+            return q;
+        }
+
+        // 不检查时只按括号配对越过, 越不过去再交给Reader得到准确的错误
+        const char *Projector::skip(const char *p) {
+            if (!check_skipped_) {
+                const char *q = skip_value(p, end_);
+                if (q != nullptr)
+                    return q;
+            }
+            const char *q = checker_.parse_scalar_at(p);
+            if (q == nullptr)
+                fail(checker_.get_error(), begin_ + checker_.get_error_offset());
+            return q;
+        }
+
+        error_code parse_projected(const ProjectionData &data, Value &val, const char *begin, const char *end,
+                                   parse_mode mode, size_t &offset) {
+            Projector projector(data, begin, end, mode);
+            error_code code = projector.parse(val);
+            if (code != json::Ok)
+                offset = projector.get_error_offset();
+            return code;
+        }
+
+    }
+
+}
@@ -0,0 +1,59 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_projection.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明投影解析: 一组JSON Pointer路径预先编译为确定的状态机, 解析时只构造
+  *              路径选中的子树, 其余的值或者按Json::parse的语法检查后丢弃, 或者只按括号配对越过
+  *Function List:
+  * ProjectionState: 状态机的一个状态, 对应文档中的一个位置可能走到的全部路径前缀
+        selected为true时有路径在此结束, 整棵子树都要构造; 否则按成员的键(数组为下标的十进制)
+        在有序的edges中查找下一状态, 找不到时转到other("*"段), other为npos表示不保留
+  * 函数:
+     1. void compile_projection(const std::vector<std::string> &paths, ProjectionData &data);
+            按RFC 6901解析各路径("~0"为'~', "~1"为'/'), 段为"*"时匹配任意键或下标; 先建前缀树,
+            再用子集构造合并"*"与具体的键; 路径不合法时抛出Exception
+     2. error_code parse_projected(const ProjectionData &data, Value &val, const char *begin, const char *end,
+                                   parse_mode mode, size_t &offset);
+            按data解析[begin, end)到val, 选中的子树交给Parser构造; 路径上的容器只保留走上路径的成员,
+            其余的值交给不构造结果的Reader<Validator, false>检查, mode含UncheckedSkip时改为只按括号配对越过;
+            mode含StopWhenFound且根是对象时, 路径的第一段(不含"*")都出现过后立即结束, 其后的内容不检查.
+            返回错误码, 出错时val为Null, offset为出错处的字节偏移
+**********************************************************************************/
+
+#ifndef JSON_JSON_PROJECTION_H
+#define JSON_JSON_PROJECTION_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "json.h"
+#include "json_value.h"
+
+namespace lwy {
+
+    namespace json {
+
+        struct ProjectionState {
+            static constexpr size_t npos = static_cast<size_t>(-1);
+
+            bool selected = false;
+            std::vector<std::pair<std::string, size_t>> edges;     // 按键排序
+            size_t other = npos;
+        };
+
+        // states[0]对应文档的根
+        struct ProjectionData {
+            std::vector<ProjectionState> states;
+        };
+
+        void compile_projection(const std::vector<std::string> &paths, ProjectionData &data);
+        error_code parse_projected(const ProjectionData &data, Value &val, const char *begin, const char *end,
+                                   parse_mode mode, size_t &offset);
+
+    }
+
+}
+
+#endif //JSON_JSON_PROJECTION_H
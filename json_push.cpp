@@ -0,0 +1,68 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_push.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现JsonPushParser类, 以Parser作为PushParser的处理器构造Value树
+**********************************************************************************/
+
+#include "json_push.h"
+
+#include "json_parser.h"
+#include "json_value.h"
+
+namespace lwy {
+
+    namespace json {
+
+        struct PushData {
+            explicit PushData(Value &v) noexcept : parser(v), push(parser) { }
+
+            Parser parser;
+            PushParser<Parser> push;
+        };
+
+    }
+
+
+    JsonPushParser::JsonPushParser(Json &target) noexcept : target_(target) {
+        reset();
+    }
+
+    JsonPushParser::~JsonPushParser() noexcept = default;
+
+    void JsonPushParser::feed(const char *data, size_t length) {
+        try {
+            d->push.feed(data, length);
+        } catch (...) {
+            target_.v->set_type(json::Null);
+            throw;
+        }
+    }
+
+    void JsonPushParser::finish() {
+        try {
+            d->push.finish();
+        } catch (...) {
+            target_.v->set_type(json::Null);
+            throw;
+        }
+    }
+
+    void JsonPushParser::finish(std::string &status) noexcept {
+        try {
+            finish();
+            status = "parse ok";
+        } catch (const json::Exception &msg) {
+            status = msg.what();
+        } catch (...) {
+        }
+    }
+
+    void JsonPushParser::reset() noexcept {
+        target_.v->set_type(json::Null);
+        d.reset(new json::PushData(*target_.v));
+    }
+
+}
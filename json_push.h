@@ -0,0 +1,414 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_push.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明PushParser类模板, 分块输入的增量(推送式)解析器: 输入可以在任意字节处切分,
+  *              包括字符串, 转义序列, \uXXXX, 数字和字面值的中间; 解析状态保存在显式的状态机中,
+  *              每个块到达后立即处理并向处理器发出事件, 内存只与嵌套深度和最长的单个字符串/数字有关
+  *Function List:
+  * PushParser类主要成员函数功能:
+     1. PushParser(Handler &handler);
+            handler需要提供的函数与Reader相同, 见json_reader.h, 也可以派生自json_sax.h中的SaxHandler
+     2. void feed(const char *data, size_t length);
+            处理下一块输入, 可以调用任意多次; 出错时抛出Exception, 此后的feed/finish抛出同一个错误
+     3. void finish();
+            输入结束, 检查文档是否完整; 完整的数字在此时才能确定结束并发出事件
+     4. void reset() noexcept;
+            丢弃当前状态, 开始解析下一个文档
+  * 实现说明:
+        结构字符(括号, 逗号, 冒号)与字面值直接由状态机逐字符处理; 数字与字符串先按语法收集到
+        token_中, 完整后交给Reader转换和解码, 因此数值结果, 字符串解码与错误信息都与一次性解析相同;
+        整个落在一个块内且不含转义的字符串不经过token_, 直接引用输入
+**********************************************************************************/
+
+#ifndef JSON_JSON_PUSH_H
+#define JSON_JSON_PUSH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "json.h"
+#include "json_exception.h"
+#include "json_reader.h"
+#include "json_simd.h"
+
+namespace lwy {
+
+    template <typename Handler>
+    class PushParser final{
+    public:
+        explicit PushParser(Handler &handler) noexcept : handler_(handler) { }
+
+        void feed(const char *data, size_t length);
+        void feed(const std::string &chunk) { feed(chunk.data(), chunk.size()); }
+        void finish();
+        void reset() noexcept;
+    private:
+        enum parse_state : uint8_t {
+            expect_value,       // 根, 数组中的逗号后, 或对象中的冒号后
+            array_first,        // '['之后
+            array_next,         // 数组元素之后
+            object_first,       // '{'之后
+            object_key,         // 对象中的逗号后
+            object_colon,       // 键之后
+            object_next,        // 对象成员的值之后
+            root_done,          // 根已结束, 只允许空白
+            in_literal,
+            in_number,
+            in_string,
+            failed
+        };
+        // 数字语法中的位置, 名称表示刚读过的部分
+        enum number_state : uint8_t {
+            num_minus, num_zero, num_int, num_dot, num_frac, num_exp, num_exp_sign, num_exp_digits
+        };
+        struct Frame {
+            bool object;
+            size_t count;
+        };
+        // 把Reader解析出的字符串作为键转交给处理器
+        struct KeyHandler {
+            Handler &handler;
+            void on_null() { }
+            void on_bool(bool) { }
+            void on_double(double) { }
+            void on_int64(int64_t) { }
+            void on_uint64(uint64_t) { }
+            void on_string(const char *str, size_t length, bool escape_free) {
+                handler.on_key(str, length, escape_free);
+            }
+            void on_start_array() { }
+            void on_end_array(size_t) { }
+            void on_start_object() { }
+            void on_key(const char *, size_t, bool) { }
+            void on_end_object(size_t) { }
+        };
+
+        void fail(const char *msg);
+        void structural(char ch);
+        void start_value(char ch);
+        void end_container();
+        void value_done() noexcept;
+        const char *scan_literal(const char *p, const char *end);
+        const char *scan_number(const char *p, const char *end);
+        json::error_code flush_number();
+        const char *start_string(const char *p, const char *end, bool key);
+        const char *scan_string(const char *p, const char *end);
+        json::error_code flush_string();
+
+        Handler &handler_;
+        parse_state state_ = expect_value;
+        number_state num_state_ = num_minus;
+        bool key_ = false;              // 正在收集的字符串是键
+        bool escape_ = false;           // 上一个字符是字符串中的'\\'
+        json::type literal_type_ = json::Null;
+        const char *literal_ = nullptr; // 正在匹配的字面值, literal_pos_之前的字符已匹配
+        size_t literal_pos_ = 0;
+        std::string token_;             // 跨块的数字或字符串, 含引号与转义的原文
+        std::vector<Frame> frames_;     // 尚未结束的数组/对象
+        std::string error_;
+    };
+
+    template <typename Handler>
+    void PushParser<Handler>::reset() noexcept {
+        state_ = expect_value;
+        escape_ = false;
+        token_.clear();
+        frames_.clear();
+        error_.clear();
+    }
+
+    template <typename Handler>
+    void PushParser<Handler>::fail(const char *msg) {
+        state_ = failed;
+        error_ = msg;
+        throw(json::Exception(msg));
+    }
+
+    template <typename Handler>
+    void PushParser<Handler>::feed(const char *data, size_t length) {
+        if (state_ == failed)
+            throw(json::Exception(error_));
+        const char *p = data, *end = data + length;
+        try {
+            while (p < end) {
+                switch (state_) {
+                    case in_literal: p = scan_literal(p, end); break;
+                    case in_number: p = scan_number(p, end); break;
+                    case in_string: p = scan_string(p, end); break;
+                    default:
+                        if (json::is_whitespace(*p)) {
+                            p = json::skip_whitespace(p + 1, end);
+                        } else if (*p == '\"' && (state_ == expect_value || state_ == array_first ||
+                                                  state_ == object_first || state_ == object_key)) {
+                            p = start_string(p + 1, end, state_ == object_first || state_ == object_key);
+                        } else {
+                            structural(*p++);
+                        }
+                        break;
+                }
+            }
+        } catch (const json::Exception &msg) {
+            state_ = failed;
+            error_ = msg.what();
+            throw;
+        } catch (...) {
+            // 处理器抛出的其他异常, 状态已不可信
+            state_ = failed;
+            error_ = "parse aborted";
+            throw;
+        }
+    }
+
+    // 输入结束相当于在末尾遇到'\0', 错误信息与一次性解析相同
+    template <typename Handler>
+    void PushParser<Handler>::finish() {
+        switch (state_) {
+            case failed: throw(json::Exception(error_));
+            case in_literal: fail("parse invalid value"); break;
+            case in_number:
+                if (num_state_ == num_minus || num_state_ == num_dot ||
+                    num_state_ == num_exp || num_state_ == num_exp_sign)
+                    fail("parse invalid value");
+                if (json::error_code code = flush_number())
+                    fail(json::error_message(code));
+                value_done();
+                break;
+            case in_string:
+                // 缺少结尾的引号, 由Reader给出具体的错误
+                if (json::error_code code = flush_string())
+                    fail(key_ ? "parse miss key" : json::error_message(code));
+                fail("parse miss quotation mark");
+                break;
+            default: break;
+        }
+        switch (state_) {
+            case expect_value: case array_first: fail("parse expect value"); break;
+            case array_next: fail("parse miss comma or square bracket"); break;
+            case object_first: case object_key: fail("parse miss key"); break;
+            case object_colon: fail("parse miss colon"); break;
+            case object_next: fail("parse miss comma or curly bracket"); break;
+            default: break;
+        }
+    }
+
+    // 处理值以外的一个非空白字符
+    template <typename Handler>
+    void PushParser<Handler>::structural(char ch) {
+        switch (state_) {
+            case expect_value: start_value(ch); break;
+            case array_first:
+                if (ch == ']') end_container();
+                else start_value(ch);
+                break;
+            case array_next:
+                if (ch == ',') state_ = expect_value;
+                else if (ch == ']') end_container();
+                else fail("parse miss comma or square bracket");
+                break;
+            case object_first:
+                if (ch == '}') end_container();
+                else fail("parse miss key");
+                break;
+            case object_key: fail("parse miss key"); break;
+            case object_colon:
+                if (ch == ':') state_ = expect_value;
+                else fail("parse miss colon");
+                break;
+            case object_next:
+                if (ch == ',') state_ = object_key;
+                else if (ch == '}') end_container();
+                else fail("parse miss comma or curly bracket");
+                break;
+            default: fail("parse root not singular"); break;
+        }
+    }
+
+    template <typename Handler>
+    void PushParser<Handler>::start_value(char ch) {
+        switch (ch) {
+            case 'n': literal_ = "null"; literal_type_ = json::Null; break;
+            case 't': literal_ = "true"; literal_type_ = json::True; break;
+            case 'f': literal_ = "false"; literal_type_ = json::False; break;
+            case '[':
+                handler_.on_start_array();
+                frames_.push_back(Frame{false, 0});
+                state_ = array_first;
+                return;
+            case '{':
+                handler_.on_start_object();
+                frames_.push_back(Frame{true, 0});
+                state_ = object_first;
+                return;
+            case '\0': fail("parse expect value"); return;
+            default:
+                if (ch == '-') num_state_ = num_minus;
+                else if (ch == '0') num_state_ = num_zero;
+                else if (json::is_digit(ch)) num_state_ = num_int;
+                else fail("parse invalid value");
+                token_.assign(1, ch);
+                state_ = in_number;
+                return;
+        }
+        literal_pos_ = 1;
+        state_ = in_literal;
+    }
+
+    template <typename Handler>
+    void PushParser<Handler>::end_container() {
+        Frame f = frames_.back();
+        frames_.pop_back();
+        if (f.object)
+            handler_.on_end_object(f.count);
+        else
+            handler_.on_end_array(f.count);
+        value_done();
+    }
+
+    template <typename Handler>
+    void PushParser<Handler>::value_done() noexcept {
+        if (frames_.empty()) {
+            state_ = root_done;
+            return;
+        }
+        Frame &f = frames_.back();
+        ++f.count;
+        state_ = f.object ? object_next : array_next;
+    }
+
+    template <typename Handler>
+    const char *PushParser<Handler>::scan_literal(const char *p, const char *end) {
+        for (; p < end && literal_[literal_pos_]; ++p, ++literal_pos_)
+            if (*p != literal_[literal_pos_])
+                fail("parse invalid value");
+        if (literal_[literal_pos_] == '\0') {
+            if (literal_type_ == json::Null)
+                handler_.on_null();
+            else
+                handler_.on_bool(literal_type_ == json::True);
+            value_done();
+        }
+        return p;
+    }
+
+    // 数字在遇到第一个不属于它的字符时结束, 该字符留给外层状态处理
+    template <typename Handler>
+    const char *PushParser<Handler>::scan_number(const char *p, const char *end) {
+        const char *begin = p;
+        for (; p < end; ++p) {
+            char ch = *p;
+            switch (num_state_) {
+                case num_minus:
+                    if (ch == '0') num_state_ = num_zero;
+                    else if (json::is_digit(ch)) num_state_ = num_int;
+                    else fail("parse invalid value");
+                    break;
+                case num_zero: case num_int: case num_frac:
+                    if (json::is_digit(ch) && num_state_ != num_zero) break;
+                    if (ch == '.' && num_state_ != num_frac) num_state_ = num_dot;
+                    else if (ch == 'e' || ch == 'E') num_state_ = num_exp;
+                    else goto done;
+                    break;
+                case num_dot:
+                    if (json::is_digit(ch)) num_state_ = num_frac;
+                    else fail("parse invalid value");
+                    break;
+                case num_exp:
+                    if (ch == '+' || ch == '-') num_state_ = num_exp_sign;
+                    else if (json::is_digit(ch)) num_state_ = num_exp_digits;
+                    else fail("parse invalid value");
+                    break;
+                case num_exp_sign:
+                    if (json::is_digit(ch)) num_state_ = num_exp_digits;
+                    else fail("parse invalid value");
+                    break;
+                case num_exp_digits:
+                    if (!json::is_digit(ch)) goto done;
+                    break;
+            }
+        }
+        token_.append(begin, p);
+        return p;
+    done:
+        token_.append(begin, p);
+        if (json::error_code code = flush_number())
+            fail(json::error_message(code));
+        value_done();
+        return p;
+    }
+
+    // token_中是语法正确的完整数字, 由Reader按与一次性解析相同的方式转换
+    template <typename Handler>
+    json::error_code PushParser<Handler>::flush_number() {
+        return json::Reader<Handler>(handler_, token_.data(), token_.data() + token_.size()).parse();
+    }
+
+    // p指向开头引号之后; 整个字符串都在本块内, 没有转义且是合法的UTF-8时直接交给处理器,
+    // 否则攒到token_中由Reader报告错误
+    template <typename Handler>
+    const char *PushParser<Handler>::start_string(const char *p, const char *end, bool key) {
+        unsigned non_ascii = 0;
+        const char *q = json::find_string_special(p, end, non_ascii);
+        if (q != end && *q == '\"' && (non_ascii == 0 || json::find_invalid_utf8(p, q) == q)) {
+            if (key) {
+                handler_.on_key(p, q - p, true);
+                state_ = object_colon;
+            } else {
+                handler_.on_string(p, q - p, true);
+                value_done();
+            }
+            return q + 1;
+        }
+        key_ = key;
+        escape_ = false;
+        token_.assign(1, '\"');
+        token_.append(p, q);
+        state_ = in_string;
+        return q;
+    }
+
+    template <typename Handler>
+    const char *PushParser<Handler>::scan_string(const char *p, const char *end) {
+        while (p < end) {
+            if (escape_) {
+                token_ += *p++;
+                escape_ = false;
+                continue;
+            }
+            const char *q = json::find_string_special(p, end);
+            token_.append(p, q);
+            p = q;
+            if (p == end)
+                break;
+            char ch = *p++;
+            token_ += ch;
+            if (ch == '\\') {
+                escape_ = true;
+            } else if (ch == '\"' || static_cast<unsigned char>(ch) < 0x20) {
+                // 控制字符使Reader报告与一次性解析相同的错误
+                if (json::error_code code = flush_string())
+                    fail(key_ ? "parse miss key" : json::error_message(code));
+                if (key_)
+                    state_ = object_colon;
+                else
+                    value_done();
+                break;
+            }
+        }
+        return p;
+    }
+
+    template <typename Handler>
+    json::error_code PushParser<Handler>::flush_string() {
+        if (key_) {
+            KeyHandler key{handler_};
+            return json::Reader<KeyHandler>(key, token_.data(), token_.data() + token_.size()).parse();
+        }
+        return json::Reader<Handler>(handler_, token_.data(), token_.data() + token_.size()).parse();
+    }
+
+}
+
+#endif //JSON_JSON_PUSH_H
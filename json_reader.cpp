@@ -0,0 +1,98 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_reader.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现Reader类模板用到的非模板辅助函数
+**********************************************************************************/
+
+#include "json_reader.h"
+
+#include <cassert>
+#include <cctype>
+
+namespace lwy {
+
+    namespace json {
+
+        const char unescape_table[256] = {
+            /* 0x00 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x10 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x20 */ 0, 0, '\"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '/',
+            /* 0x30 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x40 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x50 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+            /* 0x60 */ 0, 0, '\b', 0, 0, 0, '\f', 0, 0, 0, 0, 0, 0, 0, '\n', 0,
+            /* 0x70 */ 0, 0, '\r', 0, '\t', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        };
+
+        const char *error_message(error_code code) noexcept {
+            static const char *const messages[] = {
+                "parse ok",
+                "parse expect value",
+                "parse invalid value",
+                "parse root not singular",
+                "parse number too big",
+                "parse miss quotation mark",
+                "parse invalid string escape",
+                "parse invalid string char",
+                "parse invalid unicode hex",
+                "parse invalid unicode surrogate",
+                "parse miss comma or square bracket",
+                "parse miss key",
+                "parse miss colon",
+                "parse miss comma or curly bracket",
+                "parse cannot open file",
+                "parse cannot map file",
+                "parse invalid utf8",
+            };
+            static_assert(sizeof(messages) / sizeof(messages[0]) == json::InvalidUtf8 + 1,
+                          "every error code needs a message");
+            return messages[code];
+        }
+
+        // 四位16进制表示
+        bool parse_hex4(const char* &p, const char *end, unsigned &u) noexcept {
+            u = 0;
+            for (int i = 0; i < 4; ++i) {
+                char ch = p != end ? *p++ : '\0';
+                u <<= 4;
+                if (isdigit(ch))
+                    u |= ch - '0';
+                else if (ch >= 'A' && ch <= 'F')
+                    u |= ch - ('A' - 10);
+                else if (ch >= 'a' && ch <= 'f')
+                    u |= ch - ('a' - 10);
+                else return false;
+            }
+            return true;
+        }
+
+        // 码点范围	       码点位数	字节1	    字节2	    字节3	    字节4
+        // U+0000 ~ U+007F	  7	    0xxxxxxx
+        // U+0080 ~ U+07FF	  11	110xxxxx	10xxxxxx
+        // U+0800 ~ U+FFFF	  16	1110xxxx	10xxxxxx	10xxxxxx
+        // U+10000 ~ U+10FFFF 21	11110xxx	10xxxxxx	10xxxxxx	10xxxxxx
+        void encode_utf8(std::string &str, unsigned u) noexcept {
+            if (u <= 0x7F)
+                str += static_cast<char> (u & 0xFF);
+            else if (u <= 0x7FF) {
+                str += static_cast<char> (0xC0 | ((u >> 6) & 0xFF));
+                str += static_cast<char> (0x80 | ( u	   & 0x3F));
+            } else if (u <= 0xFFFF) {
+                str += static_cast<char> (0xE0 | ((u >> 12) & 0xFF));
+                str += static_cast<char> (0x80 | ((u >>  6) & 0x3F));
+                str += static_cast<char> (0x80 | ( u        & 0x3F));
+            } else {
+                assert(u <= 0x10FFFF);
+                str += static_cast<char> (0xF0 | ((u >> 18) & 0xFF));
+                str += static_cast<char> (0x80 | ((u >> 12) & 0x3F));
+                str += static_cast<char> (0x80 | ((u >>  6) & 0x3F));
+                str += static_cast<char> (0x80 | ( u        & 0x3F));
+            }
+        }
+
+    }
+
+}
@@ -0,0 +1,497 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_reader.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明Reader类模板, 实现JSON的语法分析, 每识别出一个值就调用处理器(Handler)
+  *              的对应函数, 由处理器决定把结果构造成何种结构(Value树, Document中的arena结点或磁带);
+  *              用户自定义的处理器通过json_sax.h中的sax_parse使用
+  *Function List:
+  * Handler需要提供的函数:
+        void on_null();  void on_bool(bool b);
+        void on_double(double d);  void on_int64(int64_t i);  void on_uint64(uint64_t u);
+        void on_string(const char *str, size_t length, bool escape_free);
+        void on_start_array();  void on_end_array(size_t count);
+        void on_start_object();  void on_key(const char *str, size_t length, bool escape_free);
+        void on_end_object(size_t count);
+            str在回调返回后即失效; escape_free为true表示字符串中没有序列化时需要转义的字符;
+            count为数组的元素个数/对象的成员个数
+  * Reader类主要成员函数功能:
+     1. Reader(Handler &handler, const char *begin, const char *end, bool check_utf8 = true);
+            待解析的内容为[begin, end), 只读取此范围内的字节, 不要求以'\0'结尾; check_utf8为true时
+            字符串(含键)的原文必须是合法的UTF-8, 否则报告InvalidUtf8, 已知输入合法时可以关闭;
+            模板参数Decode为false时只检查语法, 含转义的字符串不解码, 交给处理器的是引号之间的原文,
+            解析过程不分配内存(超长且无法快速舍入的数字除外), 供只做校验的处理器使用
+     2. error_code parse();
+            解析整个文档, 返回错误码, 出错的位置由get_error_offset()给出; 语法错误不抛出异常,
+            只有处理器自身的异常(如std::bad_alloc)会传播出来. 此前已发出的事件由处理器自行清理
+     3. void parse_value();
+            解析各种类型值的分发入口,通过遇到的第一个字符来判断要解析的值类型
+     4. void parse_number();
+            解析数字, 校验语法的同时累积十进制尾数与指数, 再由compute_double一次算出结果;
+            不带小数和指数且在64位范围内的整数由parse_integer精确识别为int64/uint64
+     5. const char *parse_string_raw(size_t &length, bool &escape_free);
+            解析字符串, 没有转义的字符串直接返回指向输入内容的指针, 不做拷贝;
+            含转义的字符串解码到buffer_中, Decode为false时只校验转义序列, 返回原文;
+            转义之间的每一段原文在拷贝前整段做UTF-8校验(见json_utf8.h), 而不是逐个字符解码
+     6. void parse_array(); void parse_object();
+            递归解析数组和对象
+     7. const char *parse_scalar_at(const char *p); const char *parse_key_at(const char *p);
+            从p处解析一个字面值, 数字或字符串(键), 返回其后的位置, 出错时返回nullptr; 供LazyJson与投影解析使用,
+            结构由调用者驱动, 标量值仍用同一套语法解析
+     8. bool fail(error_code code, const char *p) noexcept;
+            记录错误码与出错位置并返回false; 各解析函数出错时逐层返回false, 不使用异常
+  * 非模板的辅助函数:
+     1. bool parse_hex4(const char* &p, const char *end, unsigned &u) noexcept;
+            解析16进制数字, 不是合法的16进制数字时返回false
+     2. void encode_utf8(std::string &s, unsigned u) noexcept;
+            解析utf8编码字符
+**********************************************************************************/
+
+#ifndef JSON_JSON_READER_H
+#define JSON_JSON_READER_H
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include "json.h"
+#include "json_number.h"
+#include "json_simd.h"
+#include "json_utf8.h"
+
+namespace lwy {
+
+    namespace json {
+
+        // 简单转义字符 '\x' 中 x 对应的字符, 0表示非法转义, \u 单独处理
+        extern const char unescape_table[256];
+
+        bool parse_hex4(const char* &p, const char *end, unsigned &u) noexcept;
+        void encode_utf8(std::string &s, unsigned u) noexcept;
+
+        inline bool is_digit(char ch) noexcept {
+            return ch >= '0' && ch <= '9';
+        }
+
+        template <typename Handler, bool Decode = true>
+        class Reader final{
+        public:
+            Reader(Handler &handler, const char *begin, const char *end, bool check_utf8 = true) noexcept
+                    : handler_(handler), begin_(begin), cur_(begin), end_(end), check_utf8_(check_utf8) { }
+            error_code parse();
+            const char *parse_scalar_at(const char *p);
+            const char *parse_key_at(const char *p);
+            error_code get_error() const noexcept { return error_; }
+            size_t get_error_offset() const noexcept { return error_pos_ - begin_; }
+        private:
+            // 越过末尾时返回'\0', 与内容中的'\0'一样不会被误认为合法字符
+            char at(const char *p) const noexcept { return p != end_ ? *p : '\0'; }
+            char current() const noexcept { return at(cur_); }
+            bool fail(error_code code, const char *p) noexcept {
+                error_ = code;
+                error_pos_ = p;
+                return false;
+            }
+            // 定位下一个特殊字符, 并校验此前一段原文的UTF-8; 扫描时顺带取出每个字节的最高位,
+            // 纯ASCII的一段不需要再校验. 不合法时返回nullptr
+            const char *scan_string_segment(const char *p) noexcept {
+                if (!check_utf8_)
+                    return find_string_special(p, end_);
+                unsigned non_ascii = 0;
+                const char *q = find_string_special(p, end_, non_ascii);
+                if (non_ascii != 0) {
+                    const char *invalid = find_invalid_utf8(p, q);
+                    if (invalid != q) {
+                        fail(json::InvalidUtf8, invalid);
+                        return nullptr;
+                    }
+                }
+                return q;
+            }
+            void parse_whitespace() noexcept;
+            bool parse_value();
+            bool parse_literal(const char *literal, json::type t);
+            bool parse_number();
+            bool parse_integer(bool negative, uint64_t w, const char *begin, const char *end);
+            const char *parse_string_raw(size_t &length, bool &escape_free);
+            bool parse_array();
+            bool parse_object();
+
+            Handler &handler_;
+            std::string buffer_;   // 含转义的字符串解码于此, 多个字符串复用同一块内存
+            const char *begin_;
+            const char *cur_;
+            const char *end_;      // 内容的末尾, 所有读取都不越过此处
+            bool check_utf8_;
+            error_code error_ = json::Ok;
+            const char *error_pos_ = nullptr;
+        };
+
+        template <typename Handler, bool Decode>
+        error_code Reader<Handler, Decode>::parse() {
+            error_ = json::Ok;
+            error_pos_ = begin_;
+            parse_whitespace();
+            if (!parse_value())
+                return error_;
+            parse_whitespace();
+            if (cur_ != end_)
+                fail(json::RootNotSingular, cur_);
+            return error_;
+        }
+
+        template <typename Handler, bool Decode>
+        const char *Reader<Handler, Decode>::parse_scalar_at(const char *p) {
+            cur_ = p;
+            return parse_value() ? cur_ : nullptr;
+        }
+
+        template <typename Handler, bool Decode>
+        const char *Reader<Handler, Decode>::parse_key_at(const char *p) {
+            assert(*p == '\"');
+            cur_ = p;
+            size_t length;
+            bool escape_free;
+            const char *key = parse_string_raw(length, escape_free);
+            if (key == nullptr) {
+                fail(json::MissKey, p);
+                return nullptr;
+            }
+            handler_.on_key(key, length, escape_free);
+            return cur_;
+        }
+
+        // 解析空白符号
+        // 紧凑的JSON中大多数位置没有空白, 先判断一个字符再进入向量化的扫描
+        template <typename Handler, bool Decode>
+        inline void Reader<Handler, Decode>::parse_whitespace() noexcept {
+            if (cur_ != end_ && is_whitespace(*cur_))
+                cur_ = skip_whitespace(cur_ + 1, end_);
+        }
+
+        // 解析路由函数
+        template <typename Handler, bool Decode>
+        bool Reader<Handler, Decode>::parse_value() {
+            switch (current()) {
+                case 'n' : return parse_literal("null", json::Null);
+                case 't' : return parse_literal("true", json::True);
+                case 'f' : return parse_literal("false", json::False);
+                case '\"': {
+                    size_t length;
+                    bool escape_free;
+                    const char *str = parse_string_raw(length, escape_free);
+                    if (str == nullptr)
+                        return false;
+                    handler_.on_string(str, length, escape_free);
+                    return true;
+                }
+                case '[' : return parse_array();
+                case '{' : return parse_object();
+                default  : return parse_number();
+                case '\0': return fail(json::ExpectValue, cur_);
+            }
+        }
+
+        // 解析字面值, 包括ture, false, null
+        template <typename Handler, bool Decode>
+        bool Reader<Handler, Decode>::parse_literal(const char *literal, json::type t) {
+            // 将cur_对应的待解析串与literal对比
+            assert(*cur_ == literal[0]);
+            ++cur_;
+            size_t i;
+            for (i = 0; literal[i + 1]; ++i) {
+                if (at(cur_ + i) != literal[i + 1])
+                    return fail(json::InvalidValue, cur_ - 1);
+            }
+            cur_ += i;
+            if (t == json::Null)
+                handler_.on_null();
+            else
+                handler_.on_bool(t == json::True);
+            return true;
+        }
+
+        // 解析数字
+        // number = [ "-" ] int [ frac ] [ exp ]
+        // int = "0" / digit1-9 *digit
+        // frac = "." 1*digit
+        // exp = ("e" / "E") ["-" / "+"] 1*digit
+        // 只扫描一遍: 前19位有效数字累积为尾数w, 其余数字只调整指数q或记为截断
+        // 没有小数和指数部分且在64位范围内的整数直接作为int64/uint64交给处理器
+        template <typename Handler, bool Decode>
+        bool Reader<Handler, Decode>::parse_number() {
+            const char *p = cur_;
+            const char *int_begin;
+            bool negative = false, truncated = false;
+            uint64_t w = 0;
+            int64_t q = 0;
+            int digits = 0;
+            if (at(p) == '-') {
+                negative = true;
+                ++p;
+            }
+            int_begin = p;
+            if (at(p) == '0') ++p;
+            else {
+                if (!is_digit(at(p))) return fail(json::InvalidValue, cur_);
+                do {
+                    if (digits < 19) {
+                        w = w * 10 + (*p - '0');
+                        ++digits;
+                    } else {
+                        ++q;
+                        truncated |= *p != '0';
+                    }
+                } while (is_digit(at(++p)));
+            }
+            char ch = at(p);
+            if (ch != '.' && ch != 'e' && ch != 'E' && parse_integer(negative, w, int_begin, p)) {
+                cur_ = p;
+                return true;
+            }
+            if (ch == '.') {
+                if (!is_digit(at(++p))) return fail(json::InvalidValue, cur_);
+                do {
+                    if (digits < 19) {
+                        w = w * 10 + (*p - '0');
+                        --q;
+                        // 尾数为0时的前导零不计入有效数字
+                        if (w != 0) ++digits;
+                    } else {
+                        truncated |= *p != '0';
+                    }
+                } while (is_digit(at(++p)));
+            }
+            ch = at(p);
+            if (ch == 'e' || ch == 'E') {
+                ++p;
+                bool exp_negative = false;
+                ch = at(p);
+                if (ch == '+' || ch == '-') {
+                    exp_negative = ch == '-';
+                    ++p;
+                }
+                if (!is_digit(at(p))) return fail(json::InvalidValue, cur_);
+                int64_t exp = 0;
+                do {
+                    // 超出double范围的指数已能确定结果, 只需防止累加溢出
+                    if (exp < 100000000)
+                        exp = exp * 10 + (*p - '0');
+                } while (is_digit(at(++p)));
+                q += exp_negative ? -exp : exp;
+            }
+            double d;
+            if (!compute_double(w, q, negative, truncated, d))
+                d = parse_double_slow(cur_, p);
+            if (d == HUGE_VAL || d == -HUGE_VAL)
+                return fail(json::NumberTooBig, cur_);
+            cur_ = p;
+            handler_.on_double(d);
+            return true;
+        }
+
+        // 整数部分[begin, end)的前19位已累积在w中, 能以64位整数精确表示时交给处理器并返回true
+        // "-0"需要保留符号, 仍按double处理
+        template <typename Handler, bool Decode>
+        bool Reader<Handler, Decode>::parse_integer(bool negative, uint64_t w, const char *begin, const char *end) {
+            size_t digits = end - begin;
+            if (digits == 20) {
+                const uint64_t max_div10 = UINT64_MAX / 10;
+                unsigned last = end[-1] - '0';
+                if (w > max_div10 || (w == max_div10 && last > UINT64_MAX % 10))
+                    return false;
+                w = w * 10 + last;
+            } else if (digits > 20) {
+                return false;
+            }
+            if (negative) {
+                if (w == 0 || w > static_cast<uint64_t>(INT64_MAX) + 1)
+                    return false;
+                handler_.on_int64(static_cast<int64_t>(0 - w));
+            } else if (w <= static_cast<uint64_t>(INT64_MAX)) {
+                handler_.on_int64(static_cast<int64_t>(w));
+            } else {
+                handler_.on_uint64(w);
+            }
+            return true;
+        }
+
+        // 解析原始字符串, 值与键共用
+        // 扫描时已经逐段定位了转义和控制字符, 顺带记下字符串是否无需转义
+        // 出错时返回nullptr, 错误的位置为出错的字符或转义序列的开头
+        template <typename Handler, bool Decode>
+        const char *Reader<Handler, Decode>::parse_string_raw(size_t &length, bool &escape_free) {
+            assert(*cur_ == '\"');
+            const char *p = cur_ + 1;
+            const char *q = scan_string_segment(p);
+            if (q == nullptr)
+                return nullptr;
+            if (q != end_ && *q == '\"') {
+                // 没有转义的字符串直接引用输入内容
+                length = q - p;
+                escape_free = true;
+                cur_ = q + 1;
+                return p;
+            }
+            const char *begin = p;
+            if (Decode)
+                buffer_.assign(p, q);
+            p = q;
+            unsigned u = 0, u2 = 0;
+            for (; ;) {
+                if (p == end_) {
+                    fail(json::MissQuotationMark, p);
+                    return nullptr;
+                }
+                if (*p == '\"')
+                    break;
+                if (*p == 0x7f) {
+                    if (Decode)
+                        buffer_ += *p;
+                    ++p;
+                } else {
+                    if (*p == '\0') {
+                        fail(json::MissQuotationMark, p);
+                        return nullptr;
+                    }
+                    if (*p != '\\') {
+                        fail(json::InvalidStringChar, p);
+                        return nullptr;
+                    }
+                    const char *escape = p;
+                    char ch = at(++p);
+                    if (ch == '\0') {
+                        fail(json::InvalidStringEscape, escape);
+                        return nullptr;
+                    }
+                    ++p;
+                    if (ch == 'u') {
+                        if (!parse_hex4(p, end_, u)) {
+                            fail(json::InvalidUnicodeHex, escape);
+                            return nullptr;
+                        }
+                        if (u >= 0xD800 && u <= 0xDBFF) {
+                            if (at(p) != '\\' || at(p + 1) != 'u') {
+                                fail(json::InvalidUnicodeSurrogate, escape);
+                                return nullptr;
+                            }
+                            p += 2;
+                            if (!parse_hex4(p, end_, u2)) {
+                                fail(json::InvalidUnicodeHex, escape);
+                                return nullptr;
+                            }
+                            if (u2 < 0xDC00 || u2 > 0xDFFF) {
+                                fail(json::InvalidUnicodeSurrogate, escape);
+                                return nullptr;
+                            }
+                            u = (((u - 0xD800) << 10) | (u2 - 0xDC00)) + 0x10000;
+                        }
+                        if (Decode)
+                            encode_utf8(buffer_, u);
+                    } else {
+                        char decoded = unescape_table[static_cast<unsigned char>(ch)];
+                        if (decoded == 0) {
+                            fail(json::InvalidStringEscape, escape);
+                            return nullptr;
+                        }
+                        if (Decode)
+                            buffer_ += decoded;
+                    }
+                }
+                // 两个转义之间的普通字符整段校验后追加
+                q = scan_string_segment(p);
+                if (q == nullptr)
+                    return nullptr;
+                if (Decode)
+                    buffer_.append(p, q);
+                p = q;
+            }
+            cur_ = p + 1;
+            escape_free = false;
+            if (!Decode) {
+                length = p - begin;
+                return begin;
+            }
+            length = buffer_.size();
+            return buffer_.data();
+        }
+
+        template <typename Handler, bool Decode>
+        bool Reader<Handler, Decode>::parse_array() {
+            assert(*cur_ == '[');
+            ++cur_;
+            parse_whitespace();
+            handler_.on_start_array();
+            if (current() == ']') {
+                ++cur_;
+                handler_.on_end_array(0);
+                return true;
+            }
+            for (size_t count = 1; ; ++count) {
+                if (!parse_value())
+                    return false;
+                parse_whitespace();
+                char ch = current();
+                if (ch == ','){
+                    ++cur_;
+                    parse_whitespace();
+                } else if (ch == ']') {
+                    ++cur_;
+                    handler_.on_end_array(count);
+                    return true;
+                } else {
+                    return fail(json::MissCommaOrSquareBracket, cur_);
+                }
+            }
+        }
+
+        template <typename Handler, bool Decode>
+        bool Reader<Handler, Decode>::parse_object() {
+            assert(*cur_ == '{');
+            ++cur_;
+            parse_whitespace();
+            handler_.on_start_object();
+            if (current() == '}') {
+                ++cur_;
+                handler_.on_end_object(0);
+                return true;
+            }
+            for (size_t count = 1; ; ++count) {
+                if (current() != '\"')
+                    return fail(json::MissKey, cur_);
+                const char *key_begin = cur_;
+                size_t length;
+                bool escape_free;
+                const char *key = parse_string_raw(length, escape_free);
+                if (key == nullptr)
+                    return fail(json::MissKey, key_begin);
+                handler_.on_key(key, length, escape_free);
+                parse_whitespace();
+                if (current() != ':')
+                    return fail(json::MissColon, cur_);
+                ++cur_;
+                parse_whitespace();
+                if (!parse_value())
+                    return false;
+                parse_whitespace();
+                char ch = current();
+                if (ch == ',') {
+                    ++cur_;
+                    parse_whitespace();
+                } else if (ch == '}'){
+                    ++cur_;
+                    handler_.on_end_object(count);
+                    return true;
+                } else {
+                    return fail(json::MissCommaOrCurlyBracket, cur_);
+                }
+            }
+        }
+
+    }
+
+}
+
+#endif //JSON_JSON_READER_H
@@ -0,0 +1,90 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_sax.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明事件驱动(SAX)的解析接口: 解析时每识别出一个值就调用处理器的对应函数,
+  *              不构造任何树; 与Json, Document, Tape共用同一个Reader语法分析, 错误信息相同
+  *Function List:
+  * SaxHandler类模板:
+        处理器的基类, 以派生类为模板参数(CRTP), 派生类只需定义关心的事件, 其余事件什么也不做;
+        三种数字事件on_double/on_int64/on_uint64默认都转为派生类的on_number(double),
+        需要精确的64位整数时在派生类中直接定义on_int64/on_uint64.
+        事件函数均为普通成员函数, 在Reader中按处理器的静态类型调用, 可以被内联
+  * 其他函数:
+     1. template <typename Handler> void sax_parse(const std::string &content, Handler &handler, parse_mode mode);
+            解析content并向handler发出事件, 出错时抛出json::Exception, 此前已发出的事件不会撤回;
+            可选的json::parse_mode与Json::parse相同, 含json::TrustedUtf8时不校验字符串的UTF-8
+     2. template <typename Handler> void sax_parse(const std::string &content, Handler &handler,
+                                                   std::string &status, parse_mode mode) noexcept;
+            同上, 解析状态以字符串返回, 成功时为"parse ok"
+     3. template <typename Handler> void sax_parse(const char *data, size_t length, Handler &handler,
+                                                   ParseResult &result, parse_mode mode);
+            解析[data, data+length), 以错误码与出错的偏移报告结果, 内容非法时不抛出异常;
+            前两个版本都建立在此之上
+**********************************************************************************/
+
+#ifndef JSON_JSON_SAX_H
+#define JSON_JSON_SAX_H
+
+#include <cstdint>
+#include <string>
+#include "json.h"
+#include "json_exception.h"
+#include "json_reader.h"
+
+namespace lwy {
+
+    template <typename Derived>
+    class SaxHandler {
+    public:
+        void on_null() { }
+        void on_bool(bool) { }
+        void on_number(double) { }
+        void on_double(double d) { derived().on_number(d); }
+        void on_int64(int64_t i) { derived().on_number(static_cast<double>(i)); }
+        void on_uint64(uint64_t u) { derived().on_number(static_cast<double>(u)); }
+        // str在回调返回后即失效; escape_free为true表示字符串中没有序列化时需要转义的字符
+        void on_string(const char *, size_t, bool) { }
+        void on_start_array() { }
+        // count为数组的元素个数/对象的成员个数
+        void on_end_array(size_t) { }
+        void on_start_object() { }
+        void on_key(const char *, size_t, bool) { }
+        void on_end_object(size_t) { }
+    protected:
+        Derived &derived() noexcept { return static_cast<Derived &>(*this); }
+    };
+
+    template <typename Handler>
+    void sax_parse(const char *data, size_t length, Handler &handler, ParseResult &result,
+                   json::parse_mode mode = json::Recursive) {
+        json::Reader<Handler> reader(handler, data, data + length, !(mode & json::TrustedUtf8));
+        json::error_code code = reader.parse();
+        result = ParseResult(code, code == json::Ok ? 0 : reader.get_error_offset(), data);
+    }
+
+    template <typename Handler>
+    void sax_parse(const std::string &content, Handler &handler, json::parse_mode mode = json::Recursive) {
+        ParseResult result;
+        sax_parse(content.data(), content.size(), handler, result, mode);
+        if (!result)
+            throw(json::Exception(result.get_message()));
+    }
+
+    // 处理器抛出的异常不改变status
+    template <typename Handler>
+    void sax_parse(const std::string &content, Handler &handler, std::string &status,
+                   json::parse_mode mode = json::Recursive) noexcept {
+        try {
+            ParseResult result;
+            sax_parse(content.data(), content.size(), handler, result, mode);
+            status = result.get_message();
+        } catch (...) {
+        }
+    }
+
+}
+
+#endif //JSON_JSON_SAX_H
@@ -0,0 +1,122 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_simd.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现运行时的指令集检测, 以及json_simd.h中扫描函数的AVX2版本;
+  *              AVX2版本以target属性单独编译, 不要求编译时开启-mavx2
+**********************************************************************************/
+
+#include "json_simd.h"
+
+namespace lwy {
+
+    namespace json {
+
+        int detect_simd_level() noexcept {
+#if LWY_JSON_RUNTIME_AVX2
+            static const int level = __builtin_cpu_supports("avx2") ? simd_avx2
+                                   : __builtin_cpu_supports("ssse3") ? simd_ssse3 : simd_sse2;
+            return level;
+#elif LWY_JSON_SSE2
+            return simd_sse2;
+#else
+            return simd_scalar;
+#endif
+        }
+
+#if LWY_JSON_RUNTIME_AVX2
+        extern const int runtime_simd_level = detect_simd_level();
+
+        // 以下函数调用时[p, end)至少有32字节, 不足32字节的结尾从end - 32处重叠加载一次,
+        // 右移掉已经扫描过的字节, 不必退回逐字节比较
+
+        __attribute__((target("avx2")))
+        static inline unsigned whitespace_mask(__m256i chunk) noexcept {
+            const __m256i space = _mm256_set1_epi8(' ');
+            const __m256i tab = _mm256_set1_epi8('\t');
+            const __m256i lf = _mm256_set1_epi8('\n');
+            const __m256i cr = _mm256_set1_epi8('\r');
+            __m256i ws = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lf), _mm256_cmpeq_epi8(chunk, cr)));
+            return static_cast<unsigned>(_mm256_movemask_epi8(ws));
+        }
+
+        __attribute__((target("avx2")))
+        const char *skip_whitespace_avx2(const char *p, const char *end) noexcept {
+            while (end - p >= 32) {
+                unsigned mask = ~whitespace_mask(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+                if (mask != 0)
+                    return p + trailing_zeros(mask);
+                p += 32;
+            }
+            if (p == end)
+                return p;
+            unsigned shift = static_cast<unsigned>(p - (end - 32));
+            unsigned mask = ~whitespace_mask(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(end - 32))) >> shift;
+            return mask != 0 ? p + trailing_zeros(mask) : end;
+        }
+
+        // 一次加载32字节中需要特殊处理的字符的位图
+        __attribute__((target("avx2")))
+        static inline unsigned string_special_mask(__m256i chunk) noexcept {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            const __m256i ctrl = _mm256_set1_epi8(0x1F);
+            const __m256i del = _mm256_set1_epi8(0x7F);
+            // 无符号比较 ch <= 0x1F 等价于 min(ch, 0x1F) == ch
+            __m256i special = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(chunk, ctrl), chunk),
+                                    _mm256_cmpeq_epi8(chunk, del)));
+            return static_cast<unsigned>(_mm256_movemask_epi8(special));
+        }
+
+        __attribute__((target("avx2")))
+        const char *find_string_special_avx2(const char *p, const char *end) noexcept {
+            while (end - p >= 32) {
+                unsigned mask = string_special_mask(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+                if (mask != 0)
+                    return p + trailing_zeros(mask);
+                p += 32;
+            }
+            if (p == end)
+                return p;
+            unsigned shift = static_cast<unsigned>(p - (end - 32));
+            unsigned mask = string_special_mask(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(end - 32))) >> shift;
+            return mask != 0 ? p + trailing_zeros(mask) : end;
+        }
+
+        __attribute__((target("avx2")))
+        const char *find_string_special_avx2(const char *p, const char *end, unsigned &non_ascii) noexcept {
+            while (end - p >= 32) {
+                __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                unsigned mask = string_special_mask(chunk);
+                unsigned high = static_cast<unsigned>(_mm256_movemask_epi8(chunk));
+                if (mask != 0) {
+                    non_ascii |= high & below_lowest(mask);
+                    return p + trailing_zeros(mask);
+                }
+                non_ascii |= high;
+                p += 32;
+            }
+            if (p == end)
+                return p;
+            unsigned shift = static_cast<unsigned>(p - (end - 32));
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(end - 32));
+            unsigned mask = string_special_mask(chunk) >> shift;
+            unsigned high = static_cast<unsigned>(_mm256_movemask_epi8(chunk)) >> shift;
+            if (mask != 0) {
+                non_ascii |= high & below_lowest(mask);
+                return p + trailing_zeros(mask);
+            }
+            non_ascii |= high;
+            return end;
+        }
+#endif
+
+    }
+
+}
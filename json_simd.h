@@ -0,0 +1,178 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_simd.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件提供解析器与生成器共用的SIMD扫描函数, 以SSE2为基线内联展开,
+  *              一组16字节未扫完且运行时检测到AVX2时转入json_simd.cpp中一次处理32字节的实现,
+  *              其他平台退化为逐字节的标量实现
+  *Function List:
+     1. const char *skip_whitespace(const char *p, const char *end) noexcept;
+            跳过[p, end)开头连续的空白符(空格, 制表符, 换行, 回车), 返回第一个非空白符的位置;
+            只读取[p, end)内的字节, 内容不必以'\0'结尾
+     2. const char *find_string_special(const char *p, const char *end) noexcept;
+            返回[p, end)中第一个需要特殊处理的字符('"', '\\', 小于0x20的控制字符或0x7f)的位置,
+            没有则返回end; 两者之间的普通字符可以整段拷贝. 解析器和生成器共用:
+            0x7f对解析器是普通字符, 生成器则把它转义为\u007F
+        const char *find_string_special(const char *p, const char *end, unsigned &non_ascii) noexcept;
+            同上, 并把返回位置之前是否出现过不小于0x80的字节并入non_ascii(非0表示出现过);
+            最高位在同一次加载中顺带取出, 解析器据此跳过纯ASCII字符串的UTF-8校验
+     3. int detect_simd_level() noexcept;
+            运行时检测CPU支持的指令集, 返回simd_level; 结果被缓存. 上面两个函数,
+            结构索引的分类与UTF-8校验都按此结果在运行时选择实现
+**********************************************************************************/
+
+#ifndef JSON_JSON_SIMD_H
+#define JSON_JSON_SIMD_H
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LWY_JSON_RUNTIME_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LWY_JSON_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace lwy {
+
+    namespace json {
+
+        // 运行时可用的指令集, 按能力从低到高排列
+        enum simd_level : int {
+            simd_scalar,
+            simd_sse2,
+            simd_ssse3,
+            simd_avx2
+        };
+
+        int detect_simd_level() noexcept;
+
+#if LWY_JSON_RUNTIME_AVX2
+        // 静态初始化时取detect_simd_level()的结果; 初始化之前为simd_scalar, 只走内联的SSE2实现
+        extern const int runtime_simd_level;
+
+        // 以AVX2实现的版本, 只在runtime_simd_level为simd_avx2时调用
+        const char *skip_whitespace_avx2(const char *p, const char *end) noexcept;
+        const char *find_string_special_avx2(const char *p, const char *end) noexcept;
+        const char *find_string_special_avx2(const char *p, const char *end, unsigned &non_ascii) noexcept;
+#endif
+
+        inline bool is_whitespace(char ch) noexcept {
+            return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+        }
+
+        // 最低位的1所在的位置, mask不为0
+        inline unsigned trailing_zeros(unsigned mask) noexcept {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+
+        inline const char *skip_whitespace(const char *p, const char *end) noexcept {
+#if LWY_JSON_SSE2
+            const __m128i space = _mm_set1_epi8(' ');
+            const __m128i tab = _mm_set1_epi8('\t');
+            const __m128i lf = _mm_set1_epi8('\n');
+            const __m128i cr = _mm_set1_epi8('\r');
+            while (end - p >= 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                __m128i ws = _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                        _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr)));
+                unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xFFFF;
+                if (mask != 0)
+                    return p + trailing_zeros(mask);
+                p += 16;
+#if LWY_JSON_RUNTIME_AVX2
+                // 空白较长时再转入AVX2, 短的空白不必付出函数调用的代价
+                if (end - p >= 32 && runtime_simd_level >= simd_avx2)
+                    return skip_whitespace_avx2(p, end);
+#endif
+            }
+#endif
+            while (p < end && is_whitespace(*p))
+                ++p;
+            return p;
+        }
+
+        inline bool is_string_special(char ch) noexcept {
+            return ch == '\"' || ch == '\\' || static_cast<unsigned char>(ch) < 0x20 || ch == 0x7f;
+        }
+
+        inline const char *find_string_special(const char *p, const char *end) noexcept {
+#if LWY_JSON_SSE2
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i ctrl = _mm_set1_epi8(0x1F);
+            const __m128i del = _mm_set1_epi8(0x7F);
+            while (end - p >= 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                __m128i special = _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                        _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(chunk, ctrl), chunk), _mm_cmpeq_epi8(chunk, del)));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+                if (mask != 0)
+                    return p + trailing_zeros(mask);
+                p += 16;
+#if LWY_JSON_RUNTIME_AVX2
+                if (end - p >= 32 && runtime_simd_level >= simd_avx2)
+                    return find_string_special_avx2(p, end);
+#endif
+            }
+#endif
+            while (p < end && !is_string_special(*p))
+                ++p;
+            return p;
+        }
+
+        // mask中最低的1之前的各位
+        inline unsigned below_lowest(unsigned mask) noexcept {
+            return (mask & (0u - mask)) - 1;
+        }
+
+        inline const char *find_string_special(const char *p, const char *end, unsigned &non_ascii) noexcept {
+#if LWY_JSON_SSE2
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i ctrl = _mm_set1_epi8(0x1F);
+            const __m128i del = _mm_set1_epi8(0x7F);
+            while (end - p >= 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                __m128i special = _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                        _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(chunk, ctrl), chunk), _mm_cmpeq_epi8(chunk, del)));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+                unsigned high = static_cast<unsigned>(_mm_movemask_epi8(chunk));
+                if (mask != 0) {
+                    non_ascii |= high & below_lowest(mask);
+                    return p + trailing_zeros(mask);
+                }
+                non_ascii |= high;
+                p += 16;
+#if LWY_JSON_RUNTIME_AVX2
+                if (end - p >= 32 && runtime_simd_level >= simd_avx2)
+                    return find_string_special_avx2(p, end, non_ascii);
+#endif
+            }
+#endif
+            while (p < end && !is_string_special(*p)) {
+                non_ascii |= static_cast<unsigned char>(*p) & 0x80;
+                ++p;
+            }
+            return p;
+        }
+
+    }
+
+}
+
+#endif //JSON_JSON_SIMD_H
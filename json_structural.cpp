@@ -0,0 +1,210 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_structural.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现结构索引: 按64字节一块分类字符, 用位运算屏蔽字符串内部,
+  *              再把结构位图展开为位置索引. 分类有标量, SSE2与AVX2三种实现, 运行时按CPU选择
+**********************************************************************************/
+
+#include "json_structural.h"
+
+#include <cstring>
+#include "json_simd.h"
+
+namespace lwy {
+
+    namespace json {
+
+        // 一块64字节中各类字符的位图, 第i位对应第i个字节
+        struct BlockMasks {
+            uint64_t backslash;
+            uint64_t quote;
+            uint64_t whitespace;
+            uint64_t op;            // { } [ ] : ,
+        };
+
+        // 字符类别: 1反斜杠 2引号 4空白 8结构字符
+        static const unsigned char char_class[256] = {
+            /* 0x00 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 4, 0, 0, 4, 0, 0,
+            /* 0x10 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x20 */ 4, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 0, 0, 0,
+            /* 0x30 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 0, 0, 0, 0, 0,
+            /* 0x40 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x50 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 1, 8, 0, 0,
+            /* 0x60 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 0x70 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 0, 8, 0, 0,
+        };
+
+        static void classify_scalar(const char *p, BlockMasks &m) noexcept {
+            m.backslash = m.quote = m.whitespace = m.op = 0;
+            for (int i = 0; i < 64; ++i) {
+                unsigned c = char_class[static_cast<unsigned char>(p[i])];
+                uint64_t bit = uint64_t(1) << i;
+                if (c & 1) m.backslash |= bit;
+                if (c & 2) m.quote |= bit;
+                if (c & 4) m.whitespace |= bit;
+                if (c & 8) m.op |= bit;
+            }
+        }
+
+#if LWY_JSON_SSE2
+        // '['与']'的0x20位置1后分别是'{'与'}', 两次比较即可覆盖四种括号
+        static void classify_sse2(const char *p, BlockMasks &m) noexcept {
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i quote = _mm_set1_epi8('\"');
+            const __m128i space = _mm_set1_epi8(' ');
+            const __m128i tab = _mm_set1_epi8('\t');
+            const __m128i lf = _mm_set1_epi8('\n');
+            const __m128i cr = _mm_set1_epi8('\r');
+            const __m128i case_bit = _mm_set1_epi8(0x20);
+            const __m128i lbrace = _mm_set1_epi8('{');
+            const __m128i rbrace = _mm_set1_epi8('}');
+            const __m128i colon = _mm_set1_epi8(':');
+            const __m128i comma = _mm_set1_epi8(',');
+            m.backslash = m.quote = m.whitespace = m.op = 0;
+            for (int i = 0; i < 4; ++i) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i));
+                __m128i folded = _mm_or_si128(v, case_bit);
+                __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+                __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, lbrace), _mm_cmpeq_epi8(folded, rbrace)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+                int shift = 16 * i;
+                m.backslash |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)))) << shift;
+                m.quote |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << shift;
+                m.whitespace |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(ws))) << shift;
+                m.op |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(op))) << shift;
+            }
+        }
+#endif
+
+#if LWY_JSON_RUNTIME_AVX2
+        // 不要求编译时开启-mavx2, 只在运行时检测到AVX2后调用
+        __attribute__((target("avx2")))
+        static void classify_avx2(const char *p, BlockMasks &m) noexcept {
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            const __m256i quote = _mm256_set1_epi8('\"');
+            const __m256i space = _mm256_set1_epi8(' ');
+            const __m256i tab = _mm256_set1_epi8('\t');
+            const __m256i lf = _mm256_set1_epi8('\n');
+            const __m256i cr = _mm256_set1_epi8('\r');
+            const __m256i case_bit = _mm256_set1_epi8(0x20);
+            const __m256i lbrace = _mm256_set1_epi8('{');
+            const __m256i rbrace = _mm256_set1_epi8('}');
+            const __m256i colon = _mm256_set1_epi8(':');
+            const __m256i comma = _mm256_set1_epi8(',');
+            m.backslash = m.quote = m.whitespace = m.op = 0;
+            for (int i = 0; i < 2; ++i) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32 * i));
+                __m256i folded = _mm256_or_si256(v, case_bit);
+                __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                                             _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+                __m256i op = _mm256_or_si256(
+                        _mm256_or_si256(_mm256_cmpeq_epi8(folded, lbrace), _mm256_cmpeq_epi8(folded, rbrace)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma)));
+                int shift = 32 * i;
+                m.backslash |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslash)))) << shift;
+                m.quote |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << shift;
+                m.whitespace |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(ws))) << shift;
+                m.op |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(op))) << shift;
+            }
+        }
+#endif
+
+        // 每一位及其之前所有位的异或, 引号之间(含开头引号, 不含结尾引号)的位为1
+        static inline uint64_t prefix_xor(uint64_t x) noexcept {
+            x ^= x << 1;
+            x ^= x << 2;
+            x ^= x << 4;
+            x ^= x << 8;
+            x ^= x << 16;
+            x ^= x << 32;
+            return x;
+        }
+
+        // 被转义的字符: 前面有奇数个连续反斜杠的位置. prev_escaped记录上一块最后的反斜杠是否转义了本块第一个字符
+        static inline uint64_t find_escaped(uint64_t backslash, uint64_t &prev_escaped) noexcept {
+            if (backslash == 0) {
+                uint64_t escaped = prev_escaped;
+                prev_escaped = 0;
+                return escaped;
+            }
+            const uint64_t even_bits = 0x5555555555555555ULL;
+            backslash &= ~prev_escaped;
+            uint64_t follows_escape = (backslash << 1) | prev_escaped;
+            // 从奇数位开始的连续反斜杠, 加上整段反斜杠后进位到序列之后的第一位
+            uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+            uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+            prev_escaped = sequences_starting_on_even_bits < odd_sequence_starts ? 1 : 0;
+            uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+            return (even_bits ^ invert_mask) & follows_escape;
+        }
+
+        static inline unsigned count_trailing_zeros(uint64_t x) noexcept {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, x);
+            return index;
+#else
+            return __builtin_ctzll(x);
+#endif
+        }
+
+        bool build_structural_index(const char *data, size_t length, std::vector<uint32_t> &index, int level) {
+            if (length >= UINT32_MAX)
+                return false;
+            void (*classify)(const char *, BlockMasks &) noexcept = classify_scalar;
+#if LWY_JSON_SSE2
+            if (level >= simd_sse2)
+                classify = classify_sse2;
+#endif
+#if LWY_JSON_RUNTIME_AVX2
+            if (level >= simd_avx2)
+                classify = classify_avx2;
+#endif
+            index.clear();
+            index.reserve(length / 6 + 16);
+            uint64_t prev_escaped = 0, prev_in_string = 0, prev_scalar = 0;
+            char tail[64];
+            for (size_t base = 0; base < length; base += 64) {
+                const char *block = data + base;
+                if (length - base < 64) {
+                    // 最后不足64字节的部分补空白, 空白不产生索引
+                    std::memset(tail, ' ', sizeof(tail));
+                    std::memcpy(tail, block, length - base);
+                    block = tail;
+                }
+                BlockMasks m;
+                classify(block, m);
+
+                uint64_t escaped = find_escaped(m.backslash, prev_escaped);
+                uint64_t quotes = m.quote & ~escaped;
+                uint64_t in_string = prefix_xor(quotes) ^ prev_in_string;
+                prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+                // 字符串内部与结尾引号; 开头引号不在其中, 作为字符串值的起始位置
+                uint64_t string_tail = in_string ^ quotes;
+                // 标量值的首字符: 非空白非结构字符, 且前一个字符不是同一个标量的一部分
+                uint64_t scalar = ~(m.op | m.whitespace);
+                uint64_t nonquote_scalar = scalar & ~quotes;
+                uint64_t follows_scalar = (nonquote_scalar << 1) | prev_scalar;
+                prev_scalar = nonquote_scalar >> 63;
+                uint64_t structurals = (m.op | (scalar & ~follows_scalar)) & ~string_tail;
+
+                while (structurals != 0) {
+                    index.push_back(static_cast<uint32_t>(base + count_trailing_zeros(structurals)));
+                    structurals &= structurals - 1;
+                }
+            }
+            index.push_back(static_cast<uint32_t>(length));
+            return true;
+        }
+
+        bool build_structural_index(const char *data, size_t length, std::vector<uint32_t> &index) {
+            return build_structural_index(data, length, index, detect_simd_level());
+        }
+
+    }
+
+}
@@ -0,0 +1,36 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_structural.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明结构索引: 用SIMD按64字节一块对输入分类, 屏蔽字符串内部(含转义的引号)后
+  *              得到所有结构字符与值的起始位置的索引, 即两阶段解析的第一阶段. 沿索引构造结果的第二阶段
+  *              仍要逐个字节解析字符串与数字, 实测加上建索引的开销后不比Reader快, 因此没有提供
+  *Function List:
+     1. bool build_structural_index(const char *data, size_t length, std::vector<uint32_t> &index, int level);
+        bool build_structural_index(const char *data, size_t length, std::vector<uint32_t> &index);
+            把[data, data+length)中字符串外的 {}[]:, 、每个字符串的开头引号、以及每个字面值/数字的首字符
+            的位置依次放入index, 末尾追加length作为哨兵; level指定分类所用的指令集,
+            省略时使用detect_simd_level()(见json_simd.h)的结果. 内容超过uint32_t的范围时返回false
+**********************************************************************************/
+
+#ifndef JSON_JSON_STRUCTURAL_H
+#define JSON_JSON_STRUCTURAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lwy {
+
+    namespace json {
+
+        bool build_structural_index(const char *data, size_t length, std::vector<uint32_t> &index, int level);
+        bool build_structural_index(const char *data, size_t length, std::vector<uint32_t> &index);
+
+    }
+
+}
+
+#endif //JSON_JSON_STRUCTURAL_H
@@ -0,0 +1,399 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_tape.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现TapeBuilder类, Value与磁带的相互转换, 以及对外的Tape, TapeView与TapeIterator类
+**********************************************************************************/
+
+#include "json_tape.h"
+
+#include <cassert>
+#include <cstring>
+#include <utility>
+#include "json_exception.h"
+#include "json_generator.h"
+#include "json_number.h"
+#include "json_reader.h"
+
+namespace lwy {
+
+    namespace json {
+
+        void TapeBuilder::on_double(double d) {
+            uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(d));
+            push_number('d', bits);
+        }
+
+        void TapeBuilder::push_number(char tag, uint64_t bits) {
+            data_.tape.push_back(make_tape_word(tag, 0));
+            data_.tape.push_back(bits);
+        }
+
+        void TapeBuilder::on_string(const char *str, size_t length, bool escape_free) {
+            uint64_t offset = data_.strings.size();
+            data_.strings.insert(data_.strings.end(), str, str + length);
+            data_.strings.push_back('\0');
+            data_.tape.push_back(make_tape_word('\"', offset | (escape_free ? tape_escape_free : 0)));
+            data_.tape.push_back(length);
+        }
+
+        void TapeBuilder::start_container(char tag) {
+            data_.starts.push_back(data_.tape.size());
+            data_.tape.push_back(make_tape_word(tag, 0));
+        }
+
+        // 结束字记录个数, 开始字回填结束字的下一个位置
+        void TapeBuilder::end_container(char tag, size_t count) {
+            size_t start = data_.starts.back();
+            data_.starts.pop_back();
+            data_.tape.push_back(make_tape_word(tag, count));
+            data_.tape[start] |= data_.tape.size();
+        }
+
+        static void reset_tape(TapeData &data) noexcept {
+            data.tape.clear();
+            data.strings.clear();
+            data.starts.clear();
+        }
+
+        // 出错(包括处理器抛出std::bad_alloc)时磁带只含一个null
+        error_code parse_tape(TapeData &data, const char *content, size_t length, parse_mode mode) {
+            reset_tape(data);
+            error_code code = json::Ok;
+            try {
+                TapeBuilder builder(data);
+                code = Reader<TapeBuilder>(builder, content, content + length, !(mode & json::TrustedUtf8)).parse();
+            } catch (...) {
+                reset_tape(data);
+                data.tape.push_back(make_tape_word('n', 0));
+                throw;
+            }
+            if (code != json::Ok) {
+                reset_tape(data);
+                data.tape.push_back(make_tape_word('n', 0));
+            }
+            assert(code != json::Ok || data.starts.empty());
+            return code;
+        }
+
+        void from_value(const Value &v, TapeBuilder &builder) {
+            switch (v.get_type()) {
+                case json::Null: builder.on_null(); break;
+                case json::True: builder.on_bool(true); break;
+                case json::False: builder.on_bool(false); break;
+                case json::Number:
+                    if (v.get_number_type() == json::Int64) builder.on_int64(v.get_int64());
+                    else if (v.get_number_type() == json::Uint64) builder.on_uint64(v.get_uint64());
+                    else builder.on_double(v.get_number());
+                    break;
+                case json::String:
+                    builder.on_string(v.get_string().data(), v.get_string().size(), v.is_escape_free());
+                    break;
+                case json::Array:
+                    builder.on_start_array();
+                    for (size_t i = 0; i < v.get_array_size(); ++i)
+                        from_value(v.get_array_element(i), builder);
+                    builder.on_end_array(v.get_array_size());
+                    break;
+                case json::Object:
+                    builder.on_start_object();
+                    for (size_t i = 0; i < v.get_object_size(); ++i) {
+                        const std::string &key = v.get_object_key(i);
+                        builder.on_key(key.data(), key.size(), false);
+                        from_value(v.get_object_value(i), builder);
+                    }
+                    builder.on_end_object(v.get_object_size());
+                    break;
+            }
+        }
+
+        void to_value(const TapeData &data, size_t index, Value &v) noexcept {
+            uint64_t word = data.tape[index];
+            switch (tape_tag(word)) {
+                case 'n': v.set_type(json::Null); break;
+                case 't': v.set_type(json::True); break;
+                case 'f': v.set_type(json::False); break;
+                case 'd': {
+                    double d;
+                    std::memcpy(&d, &data.tape[index + 1], sizeof(d));
+                    v.set_number(d);
+                    break;
+                }
+                case 'l': v.set_int64(static_cast<int64_t>(data.tape[index + 1])); break;
+                case 'u': v.set_uint64(data.tape[index + 1]); break;
+                case '\"':
+                    v.set_string(std::string(tape_string(data, index), tape_string_length(data, index)));
+                    break;
+                case '[': {
+                    size_t end = static_cast<size_t>(tape_payload(word)) - 1;
+                    std::vector<Value> arr(tape_payload(data.tape[end]));
+                    size_t i = index + 1;
+                    for (Value &e : arr) {
+                        to_value(data, i, e);
+                        i = skip(data, i);
+                    }
+                    v.set_array(std::move(arr));
+                    break;
+                }
+                case '{': {
+                    size_t end = static_cast<size_t>(tape_payload(word)) - 1;
+                    std::vector<std::pair<std::string, Value>> obj(tape_payload(data.tape[end]));
+                    size_t i = index + 1;
+                    for (auto &m : obj) {
+                        m.first.assign(tape_string(data, i), tape_string_length(data, i));
+                        to_value(data, i + 2, m.second);
+                        i = skip(data, i + 2);
+                    }
+                    v.set_object(std::move(obj));
+                    break;
+                }
+                default:
+                    assert(false);
+                    break;
+            }
+        }
+
+        // 被移动后的Tape没有数据, 视图指向这个只有一个null的磁带
+        static TapeData make_null_tape() {
+            TapeData data;
+            data.tape.push_back(make_tape_word('n', 0));
+            return data;
+        }
+        static const TapeData null_tape = make_null_tape();
+
+        // 磁带上的标签对应的json::type
+        static int tag_type(char tag) noexcept {
+            switch (tag) {
+                case 'n': return json::Null;
+                case 't': return json::True;
+                case 'f': return json::False;
+                case 'd': case 'l': case 'u': return json::Number;
+                case '\"': return json::String;
+                case '[': return json::Array;
+                default: return json::Object;
+            }
+        }
+
+    }
+
+
+    Tape::Tape() noexcept : d(new json::TapeData) {
+        d->tape.push_back(json::make_tape_word('n', 0));
+    }
+
+    Tape::~Tape() noexcept = default;
+
+    Tape::Tape(Tape &&rhs) noexcept = default;
+
+    Tape& Tape::operator=(Tape &&rhs) noexcept = default;
+
+    Tape::Tape(const JsonView &rhs) noexcept : d(new json::TapeData) {
+        json::TapeBuilder builder(*d);
+        json::from_value(*rhs.v, builder);
+    }
+
+    void Tape::parse(const std::string &content, std::string &status, json::parse_mode mode) noexcept {
+        parse(content.data(), content.size(), status, mode);
+    }
+
+    void Tape::parse(const std::string &content, json::parse_mode mode) {
+        parse(content.data(), content.size(), mode);
+    }
+
+    void Tape::parse(const char *data, size_t length, std::string &status, json::parse_mode mode) noexcept {
+        try {
+            if (d == nullptr)
+                d.reset(new json::TapeData);
+            status = json::error_message(json::parse_tape(*d, data, length, mode));
+        } catch (...) {
+        }
+    }
+
+    void Tape::parse(const char *data, size_t length, json::parse_mode mode) {
+        if (d == nullptr)
+            d.reset(new json::TapeData);
+        json::error_code code = json::parse_tape(*d, data, length, mode);
+        if (code != json::Ok)
+            throw(json::Exception(json::error_message(code)));
+    }
+
+    void Tape::stringify(std::string &content) const noexcept {
+        view().stringify(content);
+    }
+
+    // 保留已分配的容量供下次解析使用
+    void Tape::clear() noexcept {
+        if (d == nullptr)
+            return;
+        d->tape.clear();
+        d->strings.clear();
+        d->tape.push_back(json::make_tape_word('n', 0));
+    }
+
+    TapeView Tape::view() const noexcept {
+        return TapeView(d ? d.get() : &json::null_tape, 0);
+    }
+
+    size_t Tape::get_memory_usage() const noexcept {
+        if (d == nullptr)
+            return 0;
+        return d->tape.capacity() * sizeof(uint64_t) + d->strings.capacity() +
+               d->starts.capacity() * sizeof(size_t);
+    }
+
+
+    void TapeView::stringify(std::string &content) const noexcept {
+        json::Generator(*d, i, content);
+    }
+
+    int TapeView::get_type() const noexcept {
+        return json::tag_type(json::tape_tag(d->tape[i]));
+    }
+
+    double TapeView::get_number() const noexcept {
+        assert(get_type() == json::Number);
+        uint64_t bits = d->tape[i + 1];
+        switch (json::tape_tag(d->tape[i])) {
+            case 'l': return static_cast<double>(static_cast<int64_t>(bits));
+            case 'u': return static_cast<double>(bits);
+            default: {
+                double num;
+                std::memcpy(&num, &bits, sizeof(num));
+                return num;
+            }
+        }
+    }
+
+    int TapeView::get_number_type() const noexcept {
+        assert(get_type() == json::Number);
+        switch (json::tape_tag(d->tape[i])) {
+            case 'l': return json::Int64;
+            case 'u': return json::Uint64;
+            default: return json::Double;
+        }
+    }
+
+    int64_t TapeView::get_int64() const noexcept {
+        assert(get_type() == json::Number);
+        return json::tape_tag(d->tape[i]) == 'd' ? json::double_to_int64(get_number())
+                                                 : static_cast<int64_t>(d->tape[i + 1]);
+    }
+
+    uint64_t TapeView::get_uint64() const noexcept {
+        assert(get_type() == json::Number);
+        return json::tape_tag(d->tape[i]) == 'd' ? json::double_to_uint64(get_number()) : d->tape[i + 1];
+    }
+
+    const char *TapeView::get_string() const noexcept {
+        assert(get_type() == json::String);
+        return json::tape_string(*d, i);
+    }
+
+    size_t TapeView::get_string_length() const noexcept {
+        assert(get_type() == json::String);
+        return json::tape_string_length(*d, i);
+    }
+
+    // 个数记录在结束字中, 由开始字直接跳到结束字读取
+    size_t TapeView::get_array_size() const noexcept {
+        assert(get_type() == json::Array);
+        return static_cast<size_t>(json::tape_payload(d->tape[json::skip(*d, i) - 1]));
+    }
+
+    // 逐个跳过前面的元素, 顺序访问请使用迭代器
+    TapeView TapeView::get_array_element(size_t index) const noexcept {
+        assert(get_type() == json::Array && index < get_array_size());
+        size_t pos = i + 1;
+        while (index-- > 0)
+            pos = json::skip(*d, pos);
+        return TapeView(d, pos);
+    }
+
+    size_t TapeView::get_object_size() const noexcept {
+        assert(get_type() == json::Object);
+        return static_cast<size_t>(json::tape_payload(d->tape[json::skip(*d, i) - 1]));
+    }
+
+    const char *TapeView::get_object_key(size_t index) const noexcept {
+        assert(get_type() == json::Object && index < get_object_size());
+        return json::tape_string(*d, member(index));
+    }
+
+    size_t TapeView::get_object_key_length(size_t index) const noexcept {
+        assert(get_type() == json::Object && index < get_object_size());
+        return json::tape_string_length(*d, member(index));
+    }
+
+    TapeView TapeView::get_object_value(size_t index) const noexcept {
+        assert(get_type() == json::Object && index < get_object_size());
+        return TapeView(d, member(index) + 2);
+    }
+
+    long long TapeView::find_object_index(const std::string &key) const noexcept {
+        assert(get_type() == json::Object);
+        long long index = 0;
+        for (TapeIterator it = begin(), last = end(); it != last; ++it, ++index)
+            if (it.get_key_length() == key.size() && std::memcmp(it.get_key(), key.data(), key.size()) == 0)
+                return index;
+        return -1;
+    }
+
+    TapeIterator TapeView::find(const std::string &key) const noexcept {
+        assert(get_type() == json::Object);
+        TapeIterator it = begin(), last = end();
+        while (it != last && !(it.get_key_length() == key.size() &&
+                               std::memcmp(it.get_key(), key.data(), key.size()) == 0))
+            ++it;
+        return it;
+    }
+
+    TapeIterator TapeView::begin() const noexcept {
+        assert(get_type() == json::Array || get_type() == json::Object);
+        return TapeIterator(d, i + 1, get_type() == json::Object);
+    }
+
+    TapeIterator TapeView::end() const noexcept {
+        assert(get_type() == json::Array || get_type() == json::Object);
+        return TapeIterator(d, json::skip(*d, i) - 1, get_type() == json::Object);
+    }
+
+    // 第index个成员的键在磁带上的位置
+    size_t TapeView::member(size_t index) const noexcept {
+        size_t pos = i + 1;
+        while (index-- > 0)
+            pos = json::skip(*d, pos + 2);
+        return pos;
+    }
+
+
+    TapeView TapeIterator::operator*() const noexcept {
+        return TapeView(d, object ? i + 2 : i);
+    }
+
+    const char *TapeIterator::get_key() const noexcept {
+        assert(object);
+        return json::tape_string(*d, i);
+    }
+
+    size_t TapeIterator::get_key_length() const noexcept {
+        assert(object);
+        return json::tape_string_length(*d, i);
+    }
+
+    TapeIterator& TapeIterator::operator++() noexcept {
+        i = json::skip(*d, object ? i + 2 : i);
+        return *this;
+    }
+
+    bool operator==(const TapeIterator &lhs, const TapeIterator &rhs) noexcept {
+        return lhs.d == rhs.d && lhs.i == rhs.i;
+    }
+
+    bool operator!=(const TapeIterator &lhs, const TapeIterator &rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+}
@@ -0,0 +1,116 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_tape.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明只读的磁带(tape)表示: 所有值按文档顺序平铺在一个64位字的数组中,
+  *              字符串内容另存于一块连续的缓冲区; 遍历与序列化都是顺序访问, 缓存友好
+  *Function List:
+  * 磁带上每个字的最高字节为标签, 低56位为载荷:
+        'n' 't' 'f'            null, true, false, 占一个字
+        'd' 'l' 'u'            double, int64, uint64, 下一个字是数值本身
+        '"'                    字符串, 载荷为其在字符串缓冲区中的偏移(第55位记录是否无需转义),
+                               下一个字是长度; 缓冲区中的字符串以'\0'结尾
+        '[' '{'                数组/对象的开始, 载荷为对应结束字的下一个位置, 据此跳过整个容器
+        ']' '}'                数组/对象的结束, 载荷为元素/成员个数
+        对象的成员依次为 键(字符串), 值
+  * TapeBuilder类主要成员函数功能:
+     1. TapeBuilder(TapeData &data);
+            作为Reader的处理器直接构造磁带, 也可由from_value按同样的事件从Value树构造
+  * 其他函数:
+     1. error_code parse_tape(TapeData &data, const char *content, size_t length, parse_mode mode);
+            按mode解析[content, content+length)构造磁带, 返回错误码; 失败时磁带为null
+     2. void from_value(const Value &v, TapeBuilder &builder);
+        void to_value(const TapeData &data, size_t index, Value &v) noexcept;
+            Value树与磁带的相互转换
+     3. size_t skip(const TapeData &data, size_t index) noexcept;
+            返回index处的值之后的位置
+     4. const char *tape_string(const TapeData &data, size_t index) noexcept;
+        size_t tape_string_length(const TapeData &data, size_t index) noexcept;
+            index处字符串的内容与长度
+**********************************************************************************/
+
+#ifndef JSON_JSON_TAPE_H
+#define JSON_JSON_TAPE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "json.h"
+#include "json_value.h"
+
+namespace lwy {
+
+    namespace json {
+
+        const uint64_t tape_payload_mask = (uint64_t(1) << 56) - 1;
+        const uint64_t tape_escape_free = uint64_t(1) << 55;
+
+        inline uint64_t make_tape_word(char tag, uint64_t payload) noexcept {
+            return (static_cast<uint64_t>(static_cast<unsigned char>(tag)) << 56) | payload;
+        }
+        inline char tape_tag(uint64_t word) noexcept {
+            return static_cast<char>(word >> 56);
+        }
+        inline uint64_t tape_payload(uint64_t word) noexcept {
+            return word & tape_payload_mask;
+        }
+
+        struct TapeData {
+            std::vector<uint64_t> tape;
+            std::vector<char> strings;
+            std::vector<size_t> starts;     // 构造时尚未结束的容器在磁带上的位置
+        };
+
+        class TapeBuilder final{
+        public:
+            explicit TapeBuilder(TapeData &data) noexcept : data_(data) { }
+
+            void on_null() { data_.tape.push_back(make_tape_word('n', 0)); }
+            void on_bool(bool b) { data_.tape.push_back(make_tape_word(b ? 't' : 'f', 0)); }
+            void on_double(double d);
+            void on_int64(int64_t i) { push_number('l', static_cast<uint64_t>(i)); }
+            void on_uint64(uint64_t u) { push_number('u', u); }
+            void on_string(const char *str, size_t length, bool escape_free);
+            void on_start_array() { start_container('['); }
+            void on_end_array(size_t count) { end_container(']', count); }
+            void on_start_object() { start_container('{'); }
+            void on_key(const char *str, size_t length, bool escape_free) { on_string(str, length, escape_free); }
+            void on_end_object(size_t count) { end_container('}', count); }
+        private:
+            void push_number(char tag, uint64_t bits);
+            void start_container(char tag);
+            void end_container(char tag, size_t count);
+
+            TapeData &data_;
+        };
+
+        inline const char *tape_string(const TapeData &data, size_t index) noexcept {
+            return data.strings.data() + (tape_payload(data.tape[index]) & ~tape_escape_free);
+        }
+        inline size_t tape_string_length(const TapeData &data, size_t index) noexcept {
+            return static_cast<size_t>(data.tape[index + 1]);
+        }
+        inline bool tape_escape_free_string(const TapeData &data, size_t index) noexcept {
+            return (data.tape[index] & tape_escape_free) != 0;
+        }
+
+        error_code parse_tape(TapeData &data, const char *content, size_t length, parse_mode mode);
+        void from_value(const Value &v, TapeBuilder &builder);
+        void to_value(const TapeData &data, size_t index, Value &v) noexcept;
+
+        inline size_t skip(const TapeData &data, size_t index) noexcept {
+            uint64_t word = data.tape[index];
+            switch (tape_tag(word)) {
+                case '[': case '{': return static_cast<size_t>(tape_payload(word));
+                case 'd': case 'l': case 'u': case '"': return index + 2;
+                default: return index + 1;
+            }
+        }
+
+    }
+
+}
+
+#endif //JSON_JSON_TAPE_H
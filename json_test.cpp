@@ -4,12 +4,86 @@
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <string>
 #include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+#include <malloc.h>
+#define JSON_TEST_HEAP_STATS 1
+#endif
 #include "json.h"
+#include "json_push.h"
+#include "json_sax.h"
+#include "json_simd.h"
+#include "json_structural.h"
+#include "json_utf8.h"
 
 using namespace lwy;
 
+// 堆上已分配的字节数(glibc的mallinfo2, 含mmap的大块与malloc的块头), 其他平台为0
+static size_t heap_in_use() {
+#if JSON_TEST_HEAP_STATS
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+// 在新线程中运行f, 返回f结束后堆占用的增量, 用于检查不应分配内存的路径. 新线程的tcache是空的,
+// f中申请后又释放的小块会留在tcache中, 仍计为已分配, 因此临时的分配也能发现; 超过tcache上限
+// (约1KB)且已释放的块发现不了
+template <typename F>
+static size_t heap_growth(F f) {
+    size_t growth = 0;
+    std::thread t([&] {
+        std::free(std::malloc(4096));   // 先建立本线程的arena与tcache
+        size_t before = heap_in_use();
+        f();
+        growth = heap_in_use() - before;
+    });
+    t.join();
+    return growth;
+}
+
+// 按顺序记录事件, 数字经SaxHandler的默认实现转为on_number
+struct EventLog : public SaxHandler<EventLog> {
+    std::string events;
+    std::vector<double> numbers;
+    void on_null() { events += 'n'; }
+    void on_bool(bool b) { events += b ? 't' : 'f'; }
+    void on_number(double d) { events += 'd'; numbers.push_back(d); }
+    void on_string(const char *str, size_t length, bool) { events += '"' + std::string(str, length) + '"'; }
+    void on_start_array() { events += '['; }
+    void on_end_array(size_t count) { events += ']' + std::to_string(count); }
+    void on_start_object() { events += '{'; }
+    void on_key(const char *str, size_t length, bool) { events += std::string(str, length) + ':'; }
+    void on_end_object(size_t count) { events += '}' + std::to_string(count); }
+};
+
+// 只取出顶层数组中每条记录的"id", 不构造任何结点
+struct IdCollector : public SaxHandler<IdCollector> {
+    std::vector<int64_t> ids;
+    int depth = 0;
+    bool want = false;
+    void on_start_object() { ++depth; }
+    void on_end_object(size_t) { --depth; }
+    void on_key(const char *str, size_t length, bool) {
+        want = depth == 1 && length == 2 && std::memcmp(str, "id", 2) == 0;
+    }
+    void on_int64(int64_t i) {
+        if (want) ids.push_back(i);
+    }
+};
+
 class TestJson {
 public:
     static void TestLiteral(const std::string& actual, json::type expect);
@@ -21,6 +95,10 @@ public:
 
     static void TestParseLiteral();
     static void TestParseNumber();
+    static void TestNumberExact(const std::string& actual);
+    static void TestParseNumberExact();
+    static void TestInteger(const std::string& actual, int number_type);
+    static void TestParseInteger();
     static void TestParseString();
     static void TestParseArray();
 	static void TestParseObject();
@@ -34,12 +112,19 @@ public:
 	static void TestParseInvalidStringChar();
 	static void TestParseInvalidUnicodeHex();
 	static void TestParseInvalidUnicodeSurrogate();
+	static void TestParseInvalidUtf8();
 	static void TestParseMissCommaOrSquareBracket();
 	static void TestParseMissKey();
 	static void TestParseMissColon();
 	static void TestParseMissCommaOrCurlyBracket();
+	static void TestParseWhitespace();
+	static void TestParseLongString();
+	static void TestSimdScan();
 
     static void TestStringifyNumber();
+    static void TestStringifyDouble(const std::string& actual, const std::string& expect);
+    static void TestStringifyShortest();
+    static void TestStringifyReserve();
     static void TestStringifyString();
     static void TestStringifyArray();
     static void TestStringifyObject();
@@ -52,9 +137,63 @@ public:
     static void TestAccessNull();
     static void TestAccessBoolean();
     static void TestAccessNumber();
+    static void TestAccessInteger();
     static void TestAccessString();
     static void TestAccessArray();
     static void TestAccessObject();
+    static void TestAccessMove();
+    static void TestAccessLargeObject();
+    static void TestView();
+    static void TestRef();
+    static void TestDocument();
+    static void TestDocumentReuse();
+    static void TestDocumentInlineString();
+    static void TestTape();
+    static void TestTapeIterate();
+    static void TestSax();
+    static std::string PushParse(Json &v, const std::string &content, size_t chunk);
+    static void TestPush();
+    static void TestNdjson();
+    static void TestStructural();
+    static void TestParseBuffer();
+    static void TestParseResult();
+    static void TestUtf8();
+    static void TestValidate();
+    static void TestLazy();
+    static void TestProjection();
+    static void TestStopWhenFound();
+
+    static double BenchParse(const std::string& content, int repeat);
+    static void BenchParseDeepNesting();
+    static void BenchBuildArray();
+    static void BenchWalkArray();
+    static void BenchBuildObject();
+    static std::string Indent(const std::string& content);
+    static std::string MakeCorpus(int records);
+    static void BenchParseIndented();
+    static void BenchParseLongStrings();
+    static void BenchParseNumbers();
+    static void BenchIntegers();
+    static void BenchStringifyDoubles();
+    static void BenchStringifyLongStrings();
+    static void BenchStringifyCorpus();
+    static void BenchDocumentLoop();
+    static size_t CountNodes(const DocumentView &v);
+    static std::string MakeConfig(int services);
+    static void BenchMemoryPerNode();
+    static void BenchTraverse();
+    static void BenchSax();
+    static void BenchPush();
+    static std::string MakeNdjson(int records);
+    static void BenchNdjson();
+    static void BenchIndexed();
+    static void BenchParseFile();
+    static void BenchErrors();
+    static void BenchValidate();
+    static void BenchUtf8Check();
+    static void BenchLazy();
+    static void BenchProjection();
+    static void BenchStopWhenFound();
 };
 
 
@@ -104,6 +243,84 @@ void TestJson::TestParseNumber() {
     TestNumber("1e-10000", 0.0);
 }
 
+// 解析结果与strtod按位相同
+void TestJson::TestNumberExact(const std::string &actual) {
+    Json v;
+    std::string status;
+    v.parse(actual, status);
+    EXPECT_EQ("parse ok", status) << actual;
+    double expect = strtod(actual.c_str(), nullptr);
+    double d = v.get_number();
+    EXPECT_EQ(0, std::memcmp(&expect, &d, sizeof(double))) << actual;
+}
+
+void TestJson::TestParseNumberExact() {
+    // 舍入边界: 2^53附近, 两个double正中间, 最大/最小的规格化与非规格化数, 超过19位的尾数
+    const char *cases[] = {
+        "9007199254740992", "9007199254740993", "9007199254740995",
+        "0.1", "0.30000000000000004", "1e23", "8.98846567431158e307",
+        "2.2250738585072011e-308", "2.2250738585072012e-308",
+        "1.7976931348623158e308", "2.4703282292062327e-324", "2.4703282292062328e-324",
+        "3.0540412876e-321", "18446744073709551615", "18446744073709551616",
+        "123456789012345678901234567890", "179769313486231580793728971405301e276",
+        "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124",
+        "1.00000000000000011102230246251565404236316680908203126",
+        "0.000000000000000000000000000000000000000000001e10", "1e-400",
+    };
+    for (auto c : cases)
+        TestNumberExact(c);
+    std::mt19937_64 rng(20220323);
+    char buffer[32];
+    for (int i = 0; i < 20000; ++i) {
+        uint64_t bits = rng();
+        double d;
+        std::memcpy(&d, &bits, sizeof(double));
+        if (d != d || d - d != 0)
+            continue;
+        snprintf(buffer, sizeof(buffer), "%.*g", 1 + static_cast<int>(rng() % 17), d);
+        TestNumberExact(buffer);
+    }
+}
+
+// 检查数字的存储方式, 并且序列化后与原串相同
+void TestJson::TestInteger(const std::string &actual, int number_type) {
+    Json v;
+    std::string status;
+    v.parse(actual, status);
+    EXPECT_EQ("parse ok", status) << actual;
+    EXPECT_EQ(json::Number, v.get_type());
+    EXPECT_EQ(number_type, v.get_number_type()) << actual;
+    if (number_type != json::Double) {
+        v.stringify(status);
+        EXPECT_EQ(actual, status);
+    }
+}
+
+void TestJson::TestParseInteger() {
+    TestInteger("0", json::Int64);
+    TestInteger("-0", json::Double);
+    TestInteger("1", json::Int64);
+    TestInteger("-1", json::Int64);
+    TestInteger("1.0", json::Double);
+    TestInteger("1e2", json::Double);
+    TestInteger("9007199254740993", json::Int64);
+    TestInteger("9223372036854775807", json::Int64);
+    TestInteger("-9223372036854775808", json::Int64);
+    TestInteger("-9223372036854775809", json::Double);
+    TestInteger("9223372036854775808", json::Uint64);
+    TestInteger("18446744073709551615", json::Uint64);
+    TestInteger("18446744073709551616", json::Double);
+    TestInteger("123456789012345678901234", json::Double);
+
+    Json v;
+    v.parse("[9007199254740993,-9223372036854775808,18446744073709551615]");
+    EXPECT_EQ(9007199254740993LL, v.get_array_element(0).get_int64());
+    EXPECT_EQ(INT64_MIN, v.get_array_element(1).get_int64());
+    EXPECT_EQ(UINT64_MAX, v.get_array_element(2).get_uint64());
+    EXPECT_DOUBLE_EQ(9007199254740992.0, v.get_array_element(0).get_number());
+}
+
 void TestJson::TestString(const std::string& actual, const std::string& expect) {
     Json v;
     std::string status;
@@ -224,6 +441,30 @@ void TestJson::TestError(const std::string& actual, const std::string& error) {
     v.parse(actual, status);
     EXPECT_EQ(error, status);
     EXPECT_EQ(json::Null, v.get_type());
+    ParseResult result;
+    v.parse(actual, result);
+    EXPECT_FALSE(result);
+    EXPECT_EQ(error, result.get_message());
+    EXPECT_LE(result.get_offset(), actual.size());
+    // 只做校验时语法相同, 错误码与位置也相同
+    ParseResult checked = Json::validate(actual);
+    EXPECT_EQ(result.get_code(), checked.get_code()) << actual;
+    EXPECT_EQ(result.get_offset(), checked.get_offset()) << actual;
+    // Document与Json共用语法分析, 报告相同的错误
+    Document d;
+    d.parse(actual, status);
+    EXPECT_EQ(error, status) << actual;
+    EXPECT_EQ(json::Null, d.view().get_type());
+    Tape t;
+    t.parse(actual, status);
+    EXPECT_EQ(error, status) << actual;
+    EXPECT_EQ(json::Null, t.view().get_type());
+    // 增量解析在任意位置切分输入, 错误信息不变
+    for (size_t chunk : {size_t(1), size_t(3), actual.size() + 1}) {
+        Json pushed;
+        EXPECT_EQ(error, PushParse(pushed, actual, chunk)) << actual << " / " << chunk;
+        EXPECT_EQ(json::Null, pushed.get_type());
+    }
 }
 
 // 测试样例为空，期待值
@@ -307,6 +548,58 @@ void TestJson::TestParseInvalidUnicodeSurrogate() {
     TestError(R"("\uD800\uE000")", "parse invalid unicode surrogate");
 }
 
+// 字符串原文不是合法的UTF-8
+void TestJson::TestParseInvalidUtf8() {
+    TestError("\"\x80\"", "parse invalid utf8");
+    TestError("\"\xC0\xAF\"", "parse invalid utf8");
+    TestError("\"\xE0\x80\xAF\"", "parse invalid utf8");
+    TestError("\"\xED\xA0\x80\"", "parse invalid utf8");
+    TestError("\"\xF4\x90\x80\x80\"", "parse invalid utf8");
+    TestError("\"\xFE\"", "parse invalid utf8");
+    TestError("\"abc\xE4\xB8\"", "parse invalid utf8");
+    TestError("[\"\\n\xC3\"]", "parse invalid utf8");
+    TestError("[\"\xC3\\n\"]", "parse invalid utf8");
+    TestError("{\"a\": \"" + std::string(100, 'x') + "\xE4\xB8\xAD\xE4\x41\"}", "parse invalid utf8");
+    // 未闭合字符串中先出现的错误优先
+    TestError("\"\xFF", "parse invalid utf8");
+    TestError("{\"\xFF\": 1}", "parse miss key");
+
+    // 合法的多字节字符原样保留, 增量解析时可以在字符中间切分
+    const std::string text = "\"\xE4\xB8\xAD\xE6\x96\x87 caf\xC3\xA9 \xF0\x9F\x98\x80\\n\"";
+    TestString(text, "\xE4\xB8\xAD\xE6\x96\x87 caf\xC3\xA9 \xF0\x9F\x98\x80\n");
+    for (size_t chunk : {size_t(1), size_t(2), size_t(5)}) {
+        Json pushed;
+        EXPECT_EQ("parse ok", PushParse(pushed, text, chunk));
+        EXPECT_EQ("\xE4\xB8\xAD\xE6\x96\x87 caf\xC3\xA9 \xF0\x9F\x98\x80\n", pushed.get_string());
+    }
+
+    // 可信的输入跳过校验, 原文照收
+    const std::string raw = "[\"\xFF\", {\"k\": \"a\xC0\\tb\"}]";
+    Json v;
+    std::string status;
+    v.parse(raw, status, json::TrustedUtf8);
+    EXPECT_EQ("parse ok", status);
+    EXPECT_EQ("\xFF", v.get_array_element(0).get_string());
+    EXPECT_EQ("a\xC0\tb", v.get_array_element(1).get_object_value(0).get_string());
+    Tape t;
+    t.parse(raw, status, json::TrustedUtf8);
+    EXPECT_EQ("parse ok", status);
+    EXPECT_EQ(2u, t.view().get_array_size());
+    Document d;
+    d.parse(raw, status, json::TrustedUtf8);
+    EXPECT_EQ("parse ok", status);
+    EXPECT_STREQ("\xFF", d.view().get_array_element(0).get_string());
+    d.parse(raw, status);
+    EXPECT_EQ("parse invalid utf8", status);
+    EventLog sax_trusted, sax_checked;
+    sax_parse(raw, sax_trusted, status, json::TrustedUtf8);
+    EXPECT_EQ("parse ok", status);
+    sax_parse(raw, sax_checked, status);
+    EXPECT_EQ("parse invalid utf8", status);
+    v.parse(raw, status);
+    EXPECT_EQ("parse invalid utf8", status);
+}
+
 // 缺少逗号或方括号
 void TestJson::TestParseMissCommaOrSquareBracket() {
     TestError("[1", "parse miss comma or square bracket");
@@ -341,6 +634,65 @@ void TestJson::TestParseMissCommaOrCurlyBracket() {
     TestError(R"({"a":{})", "parse miss comma or curly bracket");
 }
 
+// 各种长度的空白, 覆盖向量化扫描16/32字节分组的边界以及字符串末尾
+void TestJson::TestParseWhitespace() {
+    for (int n = 0; n < 70; ++n) {
+        std::string ws;
+        for (int i = 0; i < n; ++i)
+            ws += " \t\n\r"[i % 4];
+        Json v;
+        std::string status;
+        v.parse(ws + "[" + ws + "1" + ws + "," + ws + "{" + ws + "\"a\"" + ws + ":" + ws + "null" + ws + "}" + ws + "]" + ws, status);
+        EXPECT_EQ("parse ok", status);
+        EXPECT_EQ(2, v.get_array_size());
+        v.parse(ws, status);
+        EXPECT_EQ("parse expect value", status);
+        v.parse(ws + "1" + ws + "x", status);
+        EXPECT_EQ("parse root not singular", status);
+    }
+}
+
+// 转义与非法字符出现在长字符串的不同位置, 覆盖向量化扫描的分组边界
+void TestJson::TestParseLongString() {
+    for (int n = 0; n < 70; ++n) {
+        std::string plain;
+        for (int i = 0; i < n; ++i)
+            plain += static_cast<char>('a' + i % 26);
+        TestString("\"" + plain + "\"", plain);
+        TestString("\"" + plain + "\\n" + plain + "\"", plain + "\n" + plain);
+        TestString("\"" + plain + "\\u20AC" + plain + "\\\\\"", plain + "\xE2\x82\xAC" + plain + "\\");
+        TestError("\"" + plain, "parse miss quotation mark");
+        TestError("\"" + plain + "\x01" + plain + "\"", "parse invalid string char");
+        TestError("\"" + plain + "\\x" + plain + "\"", "parse invalid string escape");
+    }
+}
+
+// 扫描函数与逐字节比较的结果一致; 目标字符出现在各个位置, 覆盖SSE2转入AVX2以及结尾重叠加载的边界
+void TestJson::TestSimdScan() {
+    for (size_t n = 0; n < 100; ++n) {
+        for (size_t pos = 0; pos <= n; ++pos) {
+            std::string ws(n, ' '), str(n, 'a');
+            if (pos < n) {
+                ws[pos] = 'x';
+                str[pos] = '\"';
+            }
+            const char *end = ws.data() + n;
+            EXPECT_EQ(pos, size_t(json::skip_whitespace(ws.data(), end) - ws.data()));
+            end = str.data() + n;
+            EXPECT_EQ(pos, size_t(json::find_string_special(str.data(), end) - str.data()));
+            // 只在目标字符之前出现的非ASCII字节才计入
+            for (size_t high : {pos / 2, pos + 1}) {
+                std::string s = str;
+                if (high < n && high != pos)
+                    s[high] = '\xE9';
+                unsigned non_ascii = 0;
+                EXPECT_EQ(pos, size_t(json::find_string_special(s.data(), s.data() + n, non_ascii) - s.data()));
+                EXPECT_EQ(high < pos, non_ascii != 0) << n << " " << pos << " " << high;
+            }
+        }
+    }
+}
+
 // RoundTrip测试
 void TestJson::TestRoundTrip(const std::string &actual) {
     Json v;
@@ -349,6 +701,27 @@ void TestJson::TestRoundTrip(const std::string &actual) {
     EXPECT_EQ("parse ok", status);
     v.stringify(status);
     EXPECT_EQ(actual, status);
+    Document d;
+    d.parse(actual, status);
+    EXPECT_EQ("parse ok", status);
+    d.stringify(status);
+    EXPECT_EQ(actual, status);
+    Tape t;
+    t.parse(actual, status);
+    EXPECT_EQ("parse ok", status);
+    t.stringify(status);
+    EXPECT_EQ(actual, status);
+    // Value树 -> 磁带 -> Value树
+    Tape converted(v);
+    converted.stringify(status);
+    EXPECT_EQ(actual, status);
+    EXPECT_EQ(1, int(Json(converted.view()) == v));
+    for (size_t chunk : {size_t(1), size_t(2), size_t(5)}) {
+        Json pushed;
+        EXPECT_EQ("parse ok", PushParse(pushed, actual, chunk));
+        pushed.stringify(status);
+        EXPECT_EQ(actual, status);
+    }
 }
 
 void TestJson::TestStringifyNumber() {
@@ -364,22 +737,122 @@ void TestJson::TestStringifyNumber() {
     TestRoundTrip("1.234e-20");
 
     TestRoundTrip("1.0000000000000002"); /* the smallest number > 1 */
-    TestRoundTrip("4.9406564584124654e-324"); /* minimum denormal */
-    TestRoundTrip("-4.9406564584124654e-324");
-    TestRoundTrip("2.2250738585072009e-308");  /* Max subnormal double */
-    TestRoundTrip("-2.2250738585072009e-308");
+    TestRoundTrip("5e-324"); /* minimum denormal */
+    TestRoundTrip("-5e-324");
+    TestRoundTrip("2.225073858507201e-308");  /* Max subnormal double */
+    TestRoundTrip("-2.225073858507201e-308");
     TestRoundTrip("2.2250738585072014e-308");  /* Min normal positive double */
     TestRoundTrip("-2.2250738585072014e-308");
     TestRoundTrip("1.7976931348623157e+308");  /* Max double */
     TestRoundTrip("-1.7976931348623157e+308");
 }
 
+// 序列化结果为最短表示expect, 且能解析回与actual相同的double
+void TestJson::TestStringifyDouble(const std::string &actual, const std::string &expect) {
+    Json v, w;
+    std::string status;
+    v.parse(actual, status);
+    EXPECT_EQ("parse ok", status) << actual;
+    std::string out;
+    v.stringify(out);
+    if (!expect.empty()) {
+        EXPECT_EQ(expect, out) << actual;
+    }
+    w.parse(out, status);
+    EXPECT_EQ("parse ok", status) << out;
+    double d1 = v.get_number(), d2 = w.get_number();
+    EXPECT_EQ(0, std::memcmp(&d1, &d2, sizeof(double))) << actual << " -> " << out;
+}
+
+void TestJson::TestStringifyShortest() {
+    TestStringifyDouble("0.1", "0.1");
+    TestStringifyDouble("0.30000000000000004", "0.30000000000000004");
+    TestStringifyDouble("1e23", "1e+23");
+    TestStringifyDouble("1e22", "1e+22");
+    TestStringifyDouble("1e16", "10000000000000000");
+    TestStringifyDouble("1.5e16", "15000000000000000");
+    TestStringifyDouble("1e17", "1e+17");
+    TestStringifyDouble("123456789.125", "123456789.125");
+    TestStringifyDouble("0.0001", "0.0001");
+    TestStringifyDouble("0.00012345", "0.00012345");
+    TestStringifyDouble("0.00001", "1e-05");
+    TestStringifyDouble("1e-100", "1e-100");
+    TestStringifyDouble("9007199254740993.0", "9007199254740992");
+    TestStringifyDouble("2.4703282292062328e-324", "5e-324");
+    TestStringifyDouble("1.7976931348623157e308", "1.7976931348623157e+308");
+    TestStringifyDouble("-1.25e-7", "-1.25e-07");
+    // 所有解析测试中的数字, 以及随机的位模式, 都要精确地往返
+    const char *cases[] = {
+        "1.0000000000000002", "4.9406564584124654e-324", "2.2250738585072009e-308",
+        "2.2250738585072014e-308", "8.98846567431158e307", "3.0540412876e-321",
+        "18446744073709551616.0", "1.00000000000000011102230246251565404236316680908203125",
+        "5e-324", "1e308", "3.14159", "1E10", "1e-10", "-1E+10", "1.234E-10",
+    };
+    for (auto c : cases)
+        TestStringifyDouble(c, "");
+    std::mt19937_64 rng(20220323);
+    char buffer[32];
+    for (int i = 0; i < 20000; ++i) {
+        uint64_t bits = rng();
+        double d;
+        std::memcpy(&d, &bits, sizeof(double));
+        if (d != d || d - d != 0)
+            continue;
+        snprintf(buffer, sizeof(buffer), "%.17g", d);
+        TestStringifyDouble(buffer, "");
+    }
+}
+
+// 序列化前预先计算长度, 输出只分配一次, 容量不超过上界
+void TestJson::TestStringifyReserve() {
+    const char *cases[] = {
+        "null", "[]", "{}", "-9223372036854775808", "18446744073709551615", "-2.2250738585072014e-308",
+        R"({"a\tb":"\u0001\\\"","":[1,-10,100,true,false,null,{}],"c":"plain"})",
+    };
+    for (auto c : cases) {
+        // 重复多次, 使预留的长度超过短字符串的容量
+        std::string content = "[";
+        for (int i = 0; i < 50; ++i)
+            content += std::string(i ? "," : "") + c;
+        content += ']';
+        Json v;
+        v.parse(content);
+        std::string out;
+        v.stringify(out);
+        EXPECT_EQ(content, out);
+        EXPECT_EQ(out.size(), out.capacity()) << c;
+    }
+    Json v;
+    v.parse(MakeCorpus(1000));
+    std::string out;
+    v.stringify(out);
+    // double按24字节估计, 其余部分是精确的
+    EXPECT_LT(out.capacity(), out.size() + 3000 * 24);
+}
+
 void TestJson::TestStringifyString() {
     TestRoundTrip(R"("")");
     TestRoundTrip(R"("Hello")");
     TestRoundTrip(R"("Hello\nWorld")");
     TestRoundTrip(R"("\" \\ / \b \f \n \r \t")");
     TestRoundTrip(R"("Hello\u0000World")");
+    TestRoundTrip(R"("\u0001\u001F\u007F")");
+    // 转义字符出现在向量化扫描的各个位置
+    for (int n = 0; n < 70; ++n) {
+        std::string plain(n, 'a');
+        TestRoundTrip("\"" + plain + "\"");
+        TestRoundTrip("\"" + plain + "\\t" + plain + "\\u007F\\\"" + plain + "\"");
+    }
+    // 解析出的无需转义的字符串被修改后仍要正确转义
+    Json v;
+    std::string out;
+    v.parse("\"abc\"");
+    v.set_string("a\"b\x7f");
+    v.stringify(out);
+    EXPECT_EQ(R"("a\"b\u007F")", out);
+    v.parse("\"a\x7f\"");
+    v.stringify(out);
+    EXPECT_EQ(R"("a\u007F")", out);
 }
 
 void TestJson::TestStringifyArray() {
@@ -475,6 +948,55 @@ void TestJson::TestAccessNumber() {
     EXPECT_DOUBLE_EQ(1234.5, v.get_number());
 }
 
+void TestJson::TestAccessInteger() {
+    Json v, w;
+    v.set_int64(-42);
+    EXPECT_EQ(json::Int64, v.get_number_type());
+    EXPECT_EQ(-42, v.get_int64());
+    EXPECT_DOUBLE_EQ(-42.0, v.get_number());
+    v.set_uint64(UINT64_MAX);
+    EXPECT_EQ(json::Uint64, v.get_number_type());
+    EXPECT_EQ(UINT64_MAX, v.get_uint64());
+    v.set_number(2.5);
+    EXPECT_EQ(json::Double, v.get_number_type());
+    EXPECT_EQ(2, v.get_int64());
+
+    // double超出整数范围时取边界值, NaN为0
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    const double doubles[] = { nan, inf, -inf, 1e30, -1e30, 9223372036854775808.0, -9223372036854775808.0, -0.5, -2.5 };
+    const int64_t int64s[] = { 0, INT64_MAX, INT64_MIN, INT64_MAX, INT64_MIN, INT64_MAX, INT64_MIN, 0, -2 };
+    const uint64_t uint64s[] = { 0, UINT64_MAX, 0, UINT64_MAX, 0, 9223372036854775808ULL, 0, 0, 0 };
+    for (size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); ++i) {
+        v.set_number(doubles[i]);
+        EXPECT_EQ(int64s[i], v.get_int64()) << i;
+        EXPECT_EQ(uint64s[i], v.get_uint64()) << i;
+    }
+    const char *clamped = "[1e30, -1e30, 18446744073709551616.0, -2.5]";
+    Document d;
+    d.parse(clamped);
+    Tape t;
+    t.parse(clamped);
+    const int64_t parsed_int64s[] = { INT64_MAX, INT64_MIN, INT64_MAX, -2 };
+    const uint64_t parsed_uint64s[] = { UINT64_MAX, 0, UINT64_MAX, 0 };
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(parsed_int64s[i], d.view().get_array_element(i).get_int64()) << i;
+        EXPECT_EQ(parsed_uint64s[i], d.view().get_array_element(i).get_uint64()) << i;
+        EXPECT_EQ(parsed_int64s[i], t.view().get_array_element(i).get_int64()) << i;
+        EXPECT_EQ(parsed_uint64s[i], t.view().get_array_element(i).get_uint64()) << i;
+    }
+
+    // 整数之间精确比较, 与double比较时按double的值
+    v.set_int64(7);
+    w.set_uint64(7);
+    EXPECT_EQ(1, int(v == w));
+    w.set_number(7.0);
+    EXPECT_EQ(1, int(v == w));
+    v.set_int64(-1);
+    w.set_uint64(UINT64_MAX);
+    EXPECT_EQ(0, int(v == w));
+}
+
 void TestJson::TestAccessString() {
     Json v;
     v.set_string("");
@@ -590,6 +1112,1987 @@ void TestJson::TestAccessObject() {
     EXPECT_EQ(0, o.get_object_size());
 }
 
+// 右值版本的set_xxx/xxx_element移动结点, 传入的Json随后变为Null
+void TestJson::TestAccessMove() {
+    Json s;
+    std::string str = "Hello";
+    s.set_string(std::move(str));
+    EXPECT_EQ("Hello", s.get_string());
+    s = std::string("World");
+    EXPECT_EQ("World", s.get_string());
+
+    Json a, e;
+    a.set_array();
+    e.parse(R"({"a":[1,2,3]})");
+    a.pushback_array_element(std::move(e));
+    EXPECT_EQ(json::Null, e.get_type());
+    e.set_string("first");
+    a.insert_array_element(std::move(e), 0);
+    EXPECT_EQ(json::Null, e.get_type());
+    EXPECT_EQ(2, a.get_array_size());
+    EXPECT_EQ("first", a.get_array_element(0).get_string());
+    EXPECT_EQ(3, a.get_array_element(1).get_object_value(0).get_array_size());
+
+    Json o, v;
+    o.set_object();
+    v.set_number(1);
+    o.set_object_value("k", std::move(v));
+    EXPECT_EQ(json::Null, v.get_type());
+    v.set_string("replaced");
+    o.set_object_value("k", std::move(v));
+    EXPECT_EQ(1, o.get_object_size());
+    EXPECT_EQ("replaced", o.get_object_value(0).get_string());
+}
+
+// 成员数超过索引阈值后, 查找/替换/删除结果与线性查找一致
+void TestJson::TestAccessLargeObject() {
+    Json o, v;
+    o.set_object();
+    for (int i = 0; i < 1000; ++i) {
+        v.set_number(i);
+        o.set_object_value("key" + std::to_string(i), v);
+    }
+    EXPECT_EQ(1000, o.get_object_size());
+    for (int i = 0; i < 1000; ++i) {
+        auto index = o.find_object_index("key" + std::to_string(i));
+        EXPECT_EQ(i, index);
+    }
+    EXPECT_EQ(-1, o.find_object_index("key1000"));
+
+    v.set_string("replaced");
+    o.set_object_value("key500", v);
+    EXPECT_EQ(1000, o.get_object_size());
+    EXPECT_EQ("replaced", o.get_object_value(500).get_string());
+
+    for (int i = 0; i < 1000; i += 2)
+        o.remove_object_value(o.find_object_index("key" + std::to_string(i)));
+    EXPECT_EQ(500, o.get_object_size());
+    for (int i = 0; i < 1000; ++i) {
+        auto index = o.find_object_index("key" + std::to_string(i));
+        if (i % 2)
+            EXPECT_EQ("key" + std::to_string(i), o.get_object_key(index));
+        else
+            EXPECT_EQ(-1, index);
+    }
+
+    Json copy = o;
+    EXPECT_EQ(1, int(copy == o));
+    o.clear_object();
+    EXPECT_EQ(-1, o.find_object_index("key1"));
+    EXPECT_EQ(0, int(copy == o));
+
+    // 解析出的重复键, 查找返回第一个
+    std::string content = "{";
+    for (int i = 0; i < 40; ++i)
+        content += "\"k" + std::to_string(i % 20) + "\":" + std::to_string(i) + ",";
+    content.back() = '}';
+    o.parse(content);
+    EXPECT_EQ(40, o.get_object_size());
+    EXPECT_EQ(3, o.find_object_index("k3"));
+
+    // 删除后索引原地更新: 后续成员前移, 同键的下一个成员接替被删的成员
+    o.remove_object_value(3);
+    EXPECT_EQ(39, o.get_object_size());
+    EXPECT_EQ(22, o.find_object_index("k3"));
+    EXPECT_DOUBLE_EQ(23.0, o.get_object_value(22).get_number());
+    EXPECT_EQ(3, o.find_object_index("k4"));
+    EXPECT_EQ(18, o.find_object_index("k19"));
+    o.remove_object_value(22);
+    EXPECT_EQ(-1, o.find_object_index("k3"));
+    for (int i = 0; i < 20; ++i) {
+        if (i == 3)
+            continue;
+        auto index = o.find_object_index("k" + std::to_string(i));
+        EXPECT_EQ(i < 3 ? i : i - 1, index);
+        EXPECT_EQ("k" + std::to_string(i), o.get_object_key(index));
+    }
+
+    // 索引在解析时建立, 查找只读, 多个线程可以同时查找同一对象
+    o.parse(content);
+    const Json &shared = o;
+    std::vector<long long> found(4, -1);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < found.size(); ++t)
+        threads.emplace_back([&shared, &found, t] { found[t] = shared.find_object_index("k" + std::to_string(t + 10)); });
+    for (auto &thread : threads)
+        thread.join();
+    for (size_t t = 0; t < found.size(); ++t)
+        EXPECT_EQ(static_cast<long long>(t + 10), found[t]);
+}
+
+void TestJson::TestView() {
+    Json v;
+    v.parse(R"({"n":null,"s":"abc","a":[1,[2,3]],"o":{"k":1.5}})");
+    JsonView root = v.view();
+    EXPECT_EQ(json::Object, root.get_type());
+    EXPECT_EQ(4, root.get_object_size());
+    EXPECT_EQ("s", root.get_object_key(1));
+    EXPECT_EQ("abc", root.get_object_value(1).get_string());
+    JsonView a = root.get_object_value(root.find_object_index("a"));
+    EXPECT_EQ(2, a.get_array_size());
+    EXPECT_DOUBLE_EQ(1.0, a.get_array_element(0).get_number());
+    EXPECT_DOUBLE_EQ(3.0, a.get_array_element(1).get_array_element(1).get_number());
+    EXPECT_DOUBLE_EQ(1.5, root.get_object_value(3).get_object_value(0).get_number());
+
+    // 句柄指向原树中的结点, 原树修改后可见
+    v.set_object_value("s", Json(root.get_object_value(3)));
+    EXPECT_EQ(json::Object, root.get_object_value(1).get_type());
+
+    Json copy(a);
+    EXPECT_EQ(1, int(copy.view() == a));
+    std::string content;
+    copy.stringify(content);
+    EXPECT_EQ("[1,[2,3]]", content);
+}
+
+void TestJson::TestDocument() {
+    Document d;
+    d.parse(R"({"n":null,"s":"a\u0000b","a":[1,[2,3]],"o":{"k":1.5},"i":-9223372036854775808,"u":18446744073709551615})");
+    DocumentView root = d.view();
+    EXPECT_EQ(json::Object, root.get_type());
+    EXPECT_EQ(6, root.get_object_size());
+    EXPECT_STREQ("s", root.get_object_key(1));
+    EXPECT_EQ(1, root.get_object_key_length(1));
+    EXPECT_EQ(json::Null, root.get_object_value(0).get_type());
+    EXPECT_EQ(std::string("a\0b", 3), std::string(root.get_object_value(1).get_string(),
+                                                   root.get_object_value(1).get_string_length()));
+    DocumentView a = root.get_object_value(root.find_object_index("a"));
+    EXPECT_EQ(2, a.get_array_size());
+    EXPECT_EQ(json::Int64, a.get_array_element(0).get_number_type());
+    EXPECT_DOUBLE_EQ(3.0, a.get_array_element(1).get_array_element(1).get_number());
+    EXPECT_DOUBLE_EQ(1.5, root.get_object_value(3).get_object_value(0).get_number());
+    EXPECT_EQ(INT64_MIN, root.get_object_value(4).get_int64());
+    EXPECT_EQ(UINT64_MAX, root.get_object_value(5).get_uint64());
+    EXPECT_EQ(-1, root.find_object_index("x"));
+
+    // 与Json解析同一文档的结果一致
+    std::string content = MakeCorpus(100), out, expect;
+    d.parse(content);
+    d.stringify(out);
+    Json v;
+    v.parse(content);
+    v.stringify(expect);
+    EXPECT_EQ(expect, out);
+    EXPECT_EQ(1, int(Json(d.view()) == v));
+    EXPECT_EQ(1, int(Json(d.view().get_array_element(7)) == v.get_array_element(7)));
+}
+
+// 重新解析复用arena中的内存块, 解析失败与clear后根结点为Null
+void TestJson::TestDocumentReuse() {
+    std::string content = MakeCorpus(2000), out;
+    Document d;
+    d.parse(content);
+    size_t usage = d.get_memory_usage();
+    EXPECT_LT(0u, usage);
+    for (int i = 0; i < 5; ++i) {
+        d.parse(content);
+        EXPECT_EQ(usage, d.get_memory_usage());
+    }
+    std::string status;
+    d.parse(content.substr(0, content.size() - 1), status);
+    EXPECT_EQ("parse miss comma or square bracket", status);
+    EXPECT_EQ(json::Null, d.view().get_type());
+    EXPECT_EQ(usage, d.get_memory_usage());
+    d.parse("[1]");
+    d.clear();
+    EXPECT_EQ(json::Null, d.view().get_type());
+
+    Document moved(std::move(d));
+    moved.parse("[1,2]");
+    moved.stringify(out);
+    EXPECT_EQ("[1,2]", out);
+    EXPECT_EQ(json::Null, d.view().get_type());
+}
+
+// 不超过15字节的字符串存放在结点内, 长度正好15时标签字节兼作'\0'
+void TestJson::TestDocumentInlineString() {
+    for (int n = 0; n < 40; ++n) {
+        std::string plain(n, 'a');
+        std::string content = "{\"" + plain + "\":[\"" + plain + "\",\"a\\n" + plain + "\",\"\\u0000" + plain + "\"]}";
+        Document d;
+        d.parse(content);
+        DocumentView root = d.view();
+        EXPECT_EQ(plain, std::string(root.get_object_key(0)));
+        EXPECT_EQ(static_cast<size_t>(n), root.get_object_key_length(0));
+        DocumentView a = root.get_object_value(0);
+        EXPECT_EQ(plain, std::string(a.get_array_element(0).get_string()));
+        EXPECT_EQ("a\n" + plain, std::string(a.get_array_element(1).get_string()));
+        EXPECT_EQ(std::string(1, '\0') + plain,
+                  std::string(a.get_array_element(2).get_string(), a.get_array_element(2).get_string_length()));
+        std::string out;
+        d.stringify(out);
+        EXPECT_EQ(content, out);
+    }
+}
+
+void TestJson::TestTape() {
+    Tape t;
+    t.parse(R"({"n":null,"s":"a\u0000b","a":[1,[2,3]],"o":{"k":1.5},"i":-9223372036854775808,"u":18446744073709551615})");
+    TapeView root = t.view();
+    EXPECT_EQ(json::Object, root.get_type());
+    EXPECT_EQ(6, root.get_object_size());
+    EXPECT_STREQ("s", root.get_object_key(1));
+    EXPECT_EQ(1, root.get_object_key_length(1));
+    EXPECT_EQ(json::Null, root.get_object_value(0).get_type());
+    EXPECT_EQ(std::string("a\0b", 3), std::string(root.get_object_value(1).get_string(),
+                                                   root.get_object_value(1).get_string_length()));
+    TapeView a = root.get_object_value(root.find_object_index("a"));
+    EXPECT_EQ(2, a.get_array_size());
+    EXPECT_EQ(json::Int64, a.get_array_element(0).get_number_type());
+    EXPECT_DOUBLE_EQ(3.0, a.get_array_element(1).get_array_element(1).get_number());
+    EXPECT_DOUBLE_EQ(1.5, root.get_object_value(3).get_object_value(0).get_number());
+    EXPECT_EQ(json::Double, root.get_object_value(3).get_object_value(0).get_number_type());
+    EXPECT_EQ(INT64_MIN, root.get_object_value(4).get_int64());
+    EXPECT_EQ(UINT64_MAX, root.get_object_value(5).get_uint64());
+    EXPECT_EQ(-1, root.find_object_index("x"));
+    std::string out;
+    a.stringify(out);
+    EXPECT_EQ("[1,[2,3]]", out);
+
+    // 与Json解析同一文档的结果一致, 两个方向的转换都不丢失信息
+    std::string content = MakeCorpus(100), expect;
+    t.parse(content);
+    t.stringify(out);
+    Json v;
+    v.parse(content);
+    v.stringify(expect);
+    EXPECT_EQ(expect, out);
+    EXPECT_EQ(1, int(Json(t.view()) == v));
+    EXPECT_EQ(1, int(Json(t.view().get_array_element(7)) == v.get_array_element(7)));
+    Tape converted(v);
+    converted.stringify(out);
+    EXPECT_EQ(expect, out);
+
+    // 解析失败与clear后为null, 被移动后的Tape视图也为null
+    std::string status;
+    t.parse(content.substr(0, content.size() - 1), status);
+    EXPECT_EQ("parse miss comma or square bracket", status);
+    EXPECT_EQ(json::Null, t.view().get_type());
+    t.parse("[1]");
+    t.clear();
+    EXPECT_EQ(json::Null, t.view().get_type());
+    Tape moved(std::move(converted));
+    EXPECT_EQ(json::Array, moved.view().get_type());
+    EXPECT_EQ(json::Null, converted.view().get_type());
+}
+
+// 迭代器与按键查找不分配内存
+void TestJson::TestTapeIterate() {
+    Tape t;
+    t.parse(R"({"a":[1,"x",[],{"b":[true]},2.5],"e":{},"c":{"d":"y"},"a":0})");
+    TapeView root = t.view();
+    std::string keys;
+    int types[5], count = 0;
+    TapeIterator c = root.end(), missing = root.end();
+    bool empty_object = false;
+    EXPECT_EQ(0, heap_growth([&] {
+        for (TapeIterator it = root.begin(); it != root.end(); ++it)
+            keys.append(it.get_key(), it.get_key_length());
+        for (TapeView e : root.get_object_value(0))
+            types[count++] = e.get_type();
+        c = root.find("c");
+        missing = root.find("z");
+        TapeView empty = root.get_object_value(1);
+        empty_object = empty.begin() == empty.end();
+    }));
+
+    EXPECT_EQ("aeca", keys);
+    ASSERT_EQ(5, count);
+    EXPECT_EQ(json::Number, types[0]);
+    EXPECT_EQ(json::String, types[1]);
+    EXPECT_EQ(json::Array, types[2]);
+    EXPECT_EQ(json::Object, types[3]);
+    EXPECT_EQ(json::Number, types[4]);
+    EXPECT_STREQ("c", c.get_key());
+    EXPECT_STREQ("y", (*c).get_object_value(0).get_string());
+    EXPECT_EQ(1, int(missing == root.end()));
+    EXPECT_EQ(1, int(empty_object));
+    // 重复的键返回第一个
+    EXPECT_EQ(json::Array, (*root.find("a")).get_type());
+    EXPECT_EQ(0, root.find_object_index("a"));
+    EXPECT_EQ(json::True, (*(*(*root.begin()).get_array_element(3).begin()).begin()).get_type());
+}
+
+void TestJson::TestSax() {
+    EventLog log;
+    std::string status;
+    sax_parse(R"([null,true,false,-2,18446744073709551615,1.5,"a\nb",{"k":[],"o":{}}])", log, status);
+    EXPECT_EQ("parse ok", status);
+    EXPECT_EQ("[ntfddd\"a\nb\"{k:[]0o:{}0}2]8", log.events);
+    ASSERT_EQ(3, log.numbers.size());
+    EXPECT_DOUBLE_EQ(-2.0, log.numbers[0]);
+    EXPECT_DOUBLE_EQ(18446744073709551615.0, log.numbers[1]);
+    EXPECT_DOUBLE_EQ(1.5, log.numbers[2]);
+
+    // 与Json相同的语法检查与错误信息, 出错前的事件已经发出
+    EventLog partial;
+    sax_parse("[1,2", partial, status);
+    EXPECT_EQ("parse miss comma or square bracket", status);
+    EXPECT_EQ("[dd", partial.events);
+    sax_parse("[1] x", partial, status);
+    EXPECT_EQ("parse root not singular", status);
+    EXPECT_THROW(sax_parse("{\"a\"}", partial), json::Exception);
+
+    IdCollector ids;
+    sax_parse(MakeCorpus(100), ids);
+    ASSERT_EQ(100, ids.ids.size());
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(i, ids.ids[i]);
+}
+
+// 按chunk字节切块送入增量解析器, 返回解析状态
+std::string TestJson::PushParse(Json &v, const std::string &content, size_t chunk) {
+    JsonPushParser parser(v);
+    std::string status;
+    try {
+        for (size_t i = 0; i < content.size(); i += chunk)
+            parser.feed(content.data() + i, std::min(chunk, content.size() - i));
+    } catch (const json::Exception &msg) {
+        return msg.what();
+    }
+    parser.finish(status);
+    return status;
+}
+
+void TestJson::TestPush() {
+    // 各种切分方式与一次性解析的结果相同
+    std::string content = MakeCorpus(50);
+    content.insert(content.size() - 1, R"(,{"esc\"aped":"\u4e2d\uD834\uDD1E\n\t tail","num":[-0,1e-7,-12.5E+3,18446744073709551615]})");
+    Json expect;
+    expect.parse(content);
+    for (size_t chunk : {size_t(1), size_t(2), size_t(3), size_t(7), size_t(64), content.size()}) {
+        Json v;
+        EXPECT_EQ("parse ok", PushParse(v, content, chunk)) << chunk;
+        EXPECT_EQ(1, int(v == expect)) << chunk;
+    }
+
+    // 处理器收到的事件与sax_parse相同; 数字要等到后继字符或finish才能确定结束
+    EventLog whole, pushed;
+    sax_parse(content, whole);
+    PushParser<EventLog> push(pushed);
+    for (size_t i = 0; i < content.size(); i += 5)
+        push.feed(content.substr(i, 5));
+    push.finish();
+    EXPECT_EQ(whole.events, pushed.events);
+    EXPECT_EQ(whole.numbers, pushed.numbers);
+
+    EventLog numbers;
+    PushParser<EventLog> number_push(numbers);
+    number_push.feed("  12");
+    number_push.feed("34");
+    EXPECT_EQ("", numbers.events);
+    number_push.finish();
+    EXPECT_EQ("d", numbers.events);
+    EXPECT_DOUBLE_EQ(1234.0, numbers.numbers[0]);
+
+    // 出错后的调用报告同一个错误, reset后可以解析下一个文档
+    number_push.reset();
+    EXPECT_THROW(number_push.feed("[1 2]"), json::Exception);
+    try {
+        number_push.finish();
+        ADD_FAILURE();
+    } catch (const json::Exception &msg) {
+        EXPECT_STREQ("parse miss comma or square bracket", msg.what());
+    }
+    number_push.reset();
+    numbers.events.clear();
+    number_push.feed("[tr");
+    number_push.feed("ue]");
+    number_push.finish();
+    EXPECT_EQ("[t]1", numbers.events);
+
+    Json v;
+    JsonPushParser parser(v);
+    parser.feed("{\"a\":[1,");
+    parser.feed(std::string("2]}"));
+    parser.finish();
+    std::string out;
+    v.stringify(out);
+    EXPECT_EQ(R"({"a":[1,2]})", out);
+    parser.reset();
+    EXPECT_EQ(json::Null, v.get_type());
+    parser.feed("\"x");
+    std::string status;
+    parser.finish(status);
+    EXPECT_EQ("parse miss quotation mark", status);
+    EXPECT_EQ(json::Null, v.get_type());
+}
+
+void TestJson::TestNdjson() {
+    std::string content = "{\"a\":1}\n"
+                          "[1,2]\r\n"
+                          "\n"
+                          "  \t\n"
+                          "[1,\n"
+                          "2]\n"
+                          "\"x\" \"y\"\n"
+                          "null";
+    std::vector<JsonLine> results;
+    NdjsonReader single(1);
+    single.parse(content, results);
+    ASSERT_EQ(6, results.size());
+    size_t lines[] = {1, 2, 5, 6, 7, 8};
+    const char *status[] = {"parse ok", "parse ok", "parse expect value",
+                            "parse root not singular", "parse root not singular", "parse ok"};
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(lines[i], results[i].line);
+        EXPECT_EQ(status[i], results[i].status);
+    }
+    EXPECT_EQ(2, results[1].value.get_array_size());
+    EXPECT_EQ(json::Null, results[2].value.get_type());
+    EXPECT_EQ(json::Null, results[5].value.get_type());
+
+    // 结果与线程数无关, 按行的顺序排列
+    std::string many = MakeNdjson(3000) + "{oops}\n" + MakeNdjson(3000);
+    std::vector<JsonLine> expect;
+    single.parse(many, expect);
+    ASSERT_EQ(6001, expect.size());
+    EXPECT_EQ("parse miss key", expect[3000].status);
+    for (size_t threads : {2, 4, 7}) {
+        NdjsonReader reader(threads);
+        EXPECT_EQ(threads, reader.get_thread_count());
+        reader.parse(many, results);
+        ASSERT_EQ(expect.size(), results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            EXPECT_EQ(expect[i].line, results[i].line);
+            EXPECT_EQ(expect[i].status, results[i].status);
+            EXPECT_EQ(1, int(expect[i].value == results[i].value));
+        }
+    }
+    single.parse("", results);
+    EXPECT_EQ(0, results.size());
+}
+
+// 逐字节计算的结构索引, 只用于合法的JSON(字符串外没有反斜杠)
+static std::vector<uint32_t> NaiveIndex(const std::string &content) {
+    std::vector<uint32_t> index;
+    bool in_string = false, escaped = false, in_scalar = false;
+    for (size_t i = 0; i < content.size(); ++i) {
+        char ch = content[i];
+        if (in_string) {
+            if (escaped)
+                escaped = false;
+            else if (ch == '\\')
+                escaped = true;
+            else if (ch == '\"')
+                in_string = false;
+            continue;
+        }
+        bool scalar = false;
+        if (ch == '\"') {
+            index.push_back(i);
+            in_string = true;
+        } else if (ch != '\0' && std::strchr("{}[]:,", ch) != nullptr) {
+            index.push_back(i);
+        } else if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            if (!in_scalar)
+                index.push_back(i);
+            scalar = true;
+        }
+        in_scalar = scalar;
+    }
+    index.push_back(content.size());
+    return index;
+}
+
+void TestJson::TestStructural() {
+    int best = json::detect_simd_level();
+    std::vector<uint32_t> expect, index;
+
+    // 转义序列与引号跨越64字节的块边界
+    std::vector<std::string> docs = {MakeCorpus(200), Indent(MakeCorpus(50)), "  true ", "[]", "-12.5e3"};
+    for (size_t pad = 0; pad < 70; ++pad) {
+        std::string s(pad, 'a');
+        docs.push_back(R"([")" + s + R"(\\",")" + s + R"(\"\\\"","x\\\\"  ,  1,")" + s.substr(0, pad % 7) + R"("]  )");
+        docs.push_back("{\"" + s + "\":[1 ,\"\\\"\" ,{\"" + s + "\\\\\":false}], \"k\":\"" + s + "\\u00e9\"}");
+    }
+    for (const std::string &doc : docs) {
+        expect = NaiveIndex(doc);
+        for (int level = json::simd_scalar; level <= best; ++level) {
+            ASSERT_TRUE(json::build_structural_index(doc.data(), doc.size(), index, level));
+            EXPECT_EQ(expect, index) << level << ": " << doc;
+        }
+    }
+
+    // 任意字节序列上各指令集的分类结果一致
+    std::mt19937 gen(18);
+    const char alphabet[] = "\"\\{}[]:, \t\n\rax0\x01\x80";
+    for (int r = 0; r < 300; ++r) {
+        std::string doc(gen() % 300, ' ');
+        for (char &ch : doc)
+            ch = alphabet[gen() % (sizeof(alphabet) - 1)];
+        json::build_structural_index(doc.data(), doc.size(), expect, json::simd_scalar);
+        for (int level = json::simd_sse2; level <= best; ++level) {
+            json::build_structural_index(doc.data(), doc.size(), index, level);
+            EXPECT_EQ(expect, index) << level;
+        }
+    }
+}
+
+void TestJson::TestParseBuffer() {
+    // 只读取给定长度内的字节: 截断在任意位置的结果与截断后的std::string相同, 之后的内容不影响解析
+    std::string doc = R"({"a":[null,true,false,-1.5e3,"s\"é𝄞"],"b":{}})";
+    Json v, expect;
+    Document d;
+    Tape t;
+    std::string status, expect_status, expect_content, content;
+    for (size_t n = 0; n <= doc.size(); ++n) {
+        expect.parse(doc.substr(0, n), expect_status);
+        expect.stringify(expect_content);
+        v.parse(doc.data(), n, status);
+        EXPECT_EQ(expect_status, status) << n;
+        EXPECT_EQ(1, int(v == expect)) << n;
+        d.parse(doc.data(), n, status);
+        EXPECT_EQ(expect_status, status) << n;
+        d.stringify(content);
+        EXPECT_EQ(expect_content, content) << n;
+        t.parse(doc.data(), n, status);
+        EXPECT_EQ(expect_status, status) << n;
+        t.stringify(content);
+        EXPECT_EQ(expect_content, content) << n;
+    }
+    std::string buffer = "[1,2]tail";
+    v.parse(buffer.data(), 5);
+    EXPECT_EQ(2, v.get_array_size());
+    v.parse(buffer.data(), 4, status);
+    EXPECT_EQ("parse miss comma or square bracket", status);
+    v.parse("\"tru", 4, status);
+    EXPECT_EQ("parse miss quotation mark", status);
+    v.parse("tru" "e", 3, status);
+    EXPECT_EQ("parse invalid value", status);
+    // 字符串字面量按'\0'结尾解析, 也可以附带解析方式
+    v.parse("[true]");
+    EXPECT_EQ(json::True, v.view().get_array_element(0).get_type());
+    v.parse("{\"k\":1}", json::TrustedUtf8);
+    EXPECT_EQ(1, v.get_object_size());
+    d.parse(buffer.data(), 5);
+    EXPECT_EQ(2, d.view().get_array_size());
+    d.parse("[true]");
+    EXPECT_EQ(json::True, d.view().get_array_element(0).get_type());
+    t.parse(buffer.data(), 5);
+    EXPECT_EQ(2, t.view().get_array_size());
+    t.parse("{\"k\":1}", status, json::TrustedUtf8);
+    EXPECT_EQ(1, t.view().get_object_size());
+#if __cplusplus >= 201703L
+    // string_view版本只读取视图内的字节; 由以C++17编译的Json17目标覆盖
+    v.parse(std::string_view(buffer.data(), 5));
+    EXPECT_EQ(2, v.get_array_size());
+    v.parse(std::string_view(buffer.data(), 4), status);
+    EXPECT_EQ("parse miss comma or square bracket", status);
+    v.parse(std::string_view(buffer.data(), 5), status, json::TrustedUtf8);
+    EXPECT_EQ("parse ok", status);
+    EXPECT_EQ(2, v.get_array_size());
+    d.parse(std::string_view(buffer.data(), 4), status);
+    EXPECT_EQ("parse miss comma or square bracket", status);
+    t.parse(std::string_view(buffer.data(), 5));
+    EXPECT_EQ(2, t.view().get_array_size());
+#endif
+
+    // 映射文件后解析, 结果与解析字符串相同
+    std::string path = testing::TempDir() + "lwy_json_parse_file.json";
+    content = MakeCorpus(500);
+    std::ofstream(path, std::ios::binary) << content;
+    expect.parse(content);
+    v.parse_file(path, status);
+    EXPECT_EQ("parse ok", status);
+    EXPECT_EQ(1, int(v == expect));
+    v.parse_file(path, status, json::TrustedUtf8);
+    EXPECT_EQ("parse ok", status);
+    EXPECT_EQ(1, int(v == expect));
+    std::ofstream(path, std::ios::binary | std::ios::trunc);
+    v.parse_file(path, status);
+    EXPECT_EQ("parse expect value", status);
+    std::remove(path.c_str());
+    v.parse_file(path, status);
+    EXPECT_EQ("parse cannot open file", status);
+    EXPECT_EQ(json::Null, v.get_type());
+}
+
+void TestJson::TestParseResult() {
+    Json v;
+    ParseResult result;
+    v.parse("[1, 2]", result);
+    EXPECT_TRUE(result);
+    EXPECT_EQ(json::Ok, result.get_code());
+    EXPECT_STREQ("parse ok", result.get_message());
+
+    // 错误码, 出错的字节偏移, 行号与列号
+    struct Case {
+        const char *content;
+        json::error_code code;
+        size_t offset, line, column;
+    } cases[] = {
+        {"", json::ExpectValue, 0, 1, 1},
+        {"  \n ", json::ExpectValue, 4, 2, 2},
+        {"[nul]", json::InvalidValue, 1, 1, 2},
+        {"[1, -x]", json::InvalidValue, 4, 1, 5},
+        {"{\"a\": 1e999}", json::NumberTooBig, 6, 1, 7},
+        {"[1,\n  2 x]", json::MissCommaOrSquareBracket, 8, 2, 5},
+        {"{\"a\":1,\n\"b\" 2}", json::MissColon, 12, 2, 5},
+        {"{\"a\":1,\n\r\n  3:4}", json::MissKey, 12, 3, 3},
+        {"{\"a\":1 ]", json::MissCommaOrCurlyBracket, 7, 1, 8},
+        {"[\"ab\\q\"]", json::InvalidStringEscape, 4, 1, 5},
+        {"[\"ab\\u12x4\"]", json::InvalidUnicodeHex, 4, 1, 5},
+        {"\"\\uD800\\n\"", json::InvalidUnicodeSurrogate, 1, 1, 2},
+        {"\"a\x01\"", json::InvalidStringChar, 2, 1, 3},
+        {"[\"abc", json::MissQuotationMark, 5, 1, 6},
+        {"true\n\nfalse", json::RootNotSingular, 6, 3, 1},
+        {"[\"a\\t\",\n\"\xE4\xB8\"]", json::InvalidUtf8, 9, 2, 2},
+    };
+    for (const Case &c : cases) {
+        v.parse(c.content, std::strlen(c.content), result);
+        EXPECT_EQ(c.code, result.get_code()) << c.content;
+        EXPECT_EQ(c.offset, result.get_offset()) << c.content;
+        EXPECT_EQ(c.line, result.get_line()) << c.content;
+        EXPECT_EQ(c.column, result.get_column()) << c.content;
+        EXPECT_EQ(json::Null, v.get_type());
+    }
+
+    // 抛出的异常与返回的状态使用同一条信息
+    try {
+        v.parse("[1,\n  2 x]");
+        ADD_FAILURE();
+    } catch (const json::Exception &msg) {
+        EXPECT_STREQ(json::error_message(json::MissCommaOrSquareBracket), msg.what());
+    }
+    EventLog log;
+    sax_parse("[1,{]", 5, log, result);
+    EXPECT_EQ(json::MissKey, result.get_code());
+    EXPECT_EQ(4, result.get_offset());
+
+    // 文件解除映射后仍能查询行号与列号
+    std::string path = testing::TempDir() + "lwy_json_parse_result.json";
+    std::ofstream(path, std::ios::binary) << "{\n  \"a\": [1, 2],\n  \"b\": tru\n}";
+    v.parse_file(path, result);
+    std::remove(path.c_str());
+    EXPECT_EQ(json::InvalidValue, result.get_code());
+    EXPECT_EQ(3, result.get_line());
+    EXPECT_EQ(8, result.get_column());
+    v.parse_file(path, result);
+    EXPECT_EQ(json::CannotOpenFile, result.get_code());
+    EXPECT_STREQ("parse cannot open file", result.get_message());
+    EXPECT_EQ(1, result.get_line());
+
+    // 解析临时的std::string, 字符串销毁后仍能查询行号与列号
+    v.parse(std::string("[1,\n 2,\n  x]"), result);
+    EXPECT_EQ(json::InvalidValue, result.get_code());
+    EXPECT_EQ(3, result.get_line());
+    EXPECT_EQ(3, result.get_column());
+    result = Json::validate(std::string("{\n\"a\" 1}"));
+    EXPECT_EQ(json::MissColon, result.get_code());
+    EXPECT_EQ(2, result.get_line());
+    EXPECT_EQ(5, result.get_column());
+}
+
+void TestJson::TestUtf8() {
+    // 合法与不合法的序列, 后者的第二项为出错序列在其中的偏移
+    std::vector<std::string> valid = {
+        "a", "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xE1\x80\x80", "\xED\x9F\xBF", "\xEE\x80\x80",
+        "\xEF\xBF\xBF", "\xF0\x90\x80\x80", "\xF3\xBF\xBF\xBF", "\xF4\x8F\xBF\xBF", "\xE4\xB8\xAD\xE6\x96\x87"
+    };
+    std::vector<std::pair<std::string, size_t>> invalid = {
+        {"\x80", 0}, {"\xBF", 0}, {"\xC0\x80", 0}, {"\xC1\xBF", 0}, {"\xC2", 0}, {"\xC2\x41", 0},
+        {"\xC2\x80\x80", 2}, {"\xE0\x80\x80", 0}, {"\xE0\x9F\xBF", 0}, {"\xE1\x80", 0}, {"\xE1\x80\x41", 0},
+        {"\xED\xA0\x80", 0}, {"\xED\xBF\xBF", 0}, {"\xF0\x80\x80\x80", 0}, {"\xF0\x8F\xBF\xBF", 0},
+        {"\xF1\x80\x80", 0}, {"\xF4\x90\x80\x80", 0}, {"\xF5\x80\x80\x80", 0}, {"\xF8", 0}, {"\xFF", 0},
+        {"a\xE4\xB8\xAD\x80", 4}, {"\xE4\xB8\xAD\xE4\xB8", 3}
+    };
+    int best = json::detect_simd_level();
+    // 出错的序列前面放不同长度的ASCII或多字节字符, 使其跨越16, 32与64字节的边界
+    for (size_t pad = 0; pad < 140; ++pad) {
+        std::string prefixes[] = {std::string(pad, 'a'), std::string(pad % 2, 'a')};
+        for (size_t i = 0; i < pad / 2; ++i)
+            prefixes[1] += "\xC3\xA9";
+        for (const std::string &prefix : prefixes) {
+            for (int level = json::simd_scalar; level <= best; ++level) {
+                for (const std::string &seq : valid) {
+                    std::string s = prefix + seq + (pad % 3 ? "xyz" : "");
+                    EXPECT_EQ(s.data() + s.size(), json::find_invalid_utf8(s.data(), s.data() + s.size(), level))
+                            << level << ": " << pad << " " << seq;
+                }
+                for (const auto &seq : invalid) {
+                    std::string s = prefix + seq.first + (pad % 3 ? "xyz" : "");
+                    EXPECT_EQ(prefix.size() + seq.second,
+                              json::find_invalid_utf8(s.data(), s.data() + s.size(), level) - s.data())
+                            << level << ": " << pad << " " << seq.first;
+                }
+            }
+        }
+    }
+
+    // 随机拼接的内容上各指令集的结果一致
+    std::mt19937 gen(21);
+    const char *pieces[] = {"a", " ", "\xC3\xA9", "\xE4\xB8\xAD", "\xF0\x9F\x98\x80", "\xED\x9F\xBF"};
+    for (int r = 0; r < 2000; ++r) {
+        std::string s;
+        size_t length = gen() % 300;
+        while (s.size() < length) {
+            if (gen() % 64 == 0)
+                s += static_cast<char>(0x80 + gen() % 0x80);
+            else
+                s += pieces[gen() % (sizeof(pieces) / sizeof(pieces[0]))];
+        }
+        const char *expect = json::find_invalid_utf8(s.data(), s.data() + s.size(), json::simd_scalar);
+        for (int level = json::simd_sse2; level <= best; ++level)
+            EXPECT_EQ(expect - s.data(), json::find_invalid_utf8(s.data(), s.data() + s.size(), level) - s.data()) << level;
+    }
+}
+
+void TestJson::TestValidate() {
+    std::vector<std::string> docs = {
+        MakeCorpus(50), Indent(MakeCorpus(20)), MakeConfig(20), "  0 ", "-1.5e-300", "[]", "{}",
+        R"(["\"\\\/\b\f\n\r\t", "\u0041\u00e9\u4e2d\uD83D\uDE00", {"\u0000key": [null, true, false]}])",
+        "[\"\xE4\xB8\xAD\xE6\x96\x87\", \"caf\xC3\xA9\", \"\xF0\x9F\x98\x80\"]",
+        "[1" + std::string(60, '0') + "e-40, 123456789012345678901234567890]"
+    };
+    for (const std::string &doc : docs) {
+        // 含转义的字符串与超长数字都不分配内存
+        ParseResult result;
+        EXPECT_EQ(0, heap_growth([&] { result = Json::validate(doc.data(), doc.size()); })) << doc;
+        EXPECT_TRUE(result) << doc;
+        EXPECT_EQ(json::Ok, result.get_code());
+    }
+#if JSON_TEST_HEAP_STATS
+    // 对照: 解析含转义的字符串时临时的分配能被发现
+    EXPECT_NE(0, heap_growth([] { Json v; v.parse(R"(["a\tb"])"); }));
+#endif
+
+    struct Case {
+        std::string content;
+        json::error_code code;
+        size_t offset;
+    } cases[] = {
+        {"[\"ok\", \"bad\xC3(\"]", json::InvalidUtf8, 11},
+        // 与其他键中的错误一样报告为缺少键
+        {"{\"k\xFF\": 1}", json::MissKey, 1},
+        {"\"\xED\xA0\x80\"", json::InvalidUtf8, 1},
+        {"[\"\xF4\x90\x80\x80\"]", json::InvalidUtf8, 2},
+        // 转义序列本身合法, 但原文中的字节不合法
+        {"[\"\\u00e9\xE9\"]", json::InvalidUtf8, 8},
+        // 先出现的错误优先; 字符串外的非ASCII字节属于语法错误
+        {"[1 2, \"\xFF\"]", json::MissCommaOrSquareBracket, 3},
+        {"[\"\xFF\", 1 2]", json::InvalidUtf8, 2},
+        {"[\xC3\xA9]", json::InvalidValue, 1},
+        {"[\"\xC3\xA9\"] \xC3\xA9", json::RootNotSingular, 7},
+    };
+    for (const Case &c : cases) {
+        ParseResult result = Json::validate(c.content);
+        EXPECT_EQ(c.code, result.get_code()) << c.content;
+        EXPECT_EQ(c.offset, result.get_offset()) << c.content;
+    }
+    ParseResult result = Json::validate("{\n  \"a\": \"\xC0\x80\"\n}");
+    EXPECT_STREQ("parse invalid utf8", result.get_message());
+    EXPECT_EQ(2, result.get_line());
+    EXPECT_EQ(9, result.get_column());
+}
+
+// 按需访问读到的值与完整解析相同, 只有访问到的部分报告错误
+void TestJson::TestLazy() {
+    std::string config = MakeConfig(50);
+    Json expect;
+    expect.parse(config);
+    LazyJson root = Json::lazy_parse(config);
+    EXPECT_EQ(json::Object, root.get_type());
+    // 向后, 往回与重复的查找
+    const int services[] = {3, 17, 49, 0, 17, 18};
+    for (int service : services) {
+        std::string name = "service-" + std::to_string(service);
+        long long index = root.find_object_index(name);
+        ASSERT_EQ(expect.find_object_index(name), index);
+        EXPECT_EQ(name, root.get_object_key(index));
+        LazyJson value = root.get_object_value(index);
+        EXPECT_EQ(expect.get_object_value(index), Json(value));
+        EXPECT_EQ(8000 + service, value.get_object_value(value.find_object_index("port")).get_int64());
+        EXPECT_EQ(-1, value.find_object_index("missing"));
+    }
+    EXPECT_EQ(-1, root.find_object_index("service-50"));
+    EXPECT_EQ(50, root.get_object_size());
+
+    std::string corpus = MakeCorpus(30);
+    Json records;
+    records.parse(corpus);
+    LazyJson array = Json::lazy_parse(corpus);
+    const size_t indexes[] = {29, 3, 4, 0, 15};
+    for (size_t index : indexes) {
+        LazyJson record = array.get_array_element(index);
+        EXPECT_EQ(records.get_array_element(index), Json(record));
+        EXPECT_EQ(index, record.get_object_value(record.find_object_index("id")).get_uint64());
+        LazyJson tags = record.get_object_value(record.find_object_index("tags"));
+        EXPECT_EQ(3, tags.get_array_size());
+        EXPECT_EQ("gamma", tags.get_array_element(2).get_string());
+    }
+    EXPECT_EQ(30, array.get_array_size());
+
+    LazyJson mixed = Json::lazy_parse(
+            " {\"a\\\"b\": \"x\\u00e9\", \"n\": -12.5, \"u\": 18446744073709551615, "
+            "\"t\": true, \"z\": null, \"e\": [ ], \"o\": {}} ");
+    EXPECT_EQ(0, mixed.find_object_index("a\"b"));
+    EXPECT_EQ("a\"b", mixed.get_object_key(0));
+    EXPECT_EQ(json::String, mixed.get_object_value(0).get_type());
+    EXPECT_EQ("x\xC3\xA9", mixed.get_object_value(0).get_string());
+    EXPECT_EQ(-12.5, mixed.get_object_value(mixed.find_object_index("n")).get_number());
+    LazyJson u = mixed.get_object_value(mixed.find_object_index("u"));
+    EXPECT_EQ(json::Uint64, u.get_number_type());
+    EXPECT_EQ(UINT64_MAX, u.get_uint64());
+    EXPECT_EQ(json::True, mixed.get_object_value(mixed.find_object_index("t")).get_type());
+    EXPECT_EQ(json::Null, mixed.get_object_value(mixed.find_object_index("z")).get_type());
+    EXPECT_EQ(0, mixed.get_object_value(mixed.find_object_index("e")).get_array_size());
+    EXPECT_EQ(0, mixed.get_object_value(mixed.find_object_index("o")).get_object_size());
+    EXPECT_EQ(7, mixed.get_object_size());
+
+    // 重复的键返回第一个, 与Json相同, 与光标的位置无关
+    const char *duplicated = R"({"a": 1, "b": 2, "a": 3, "c": 4, "b": 5})";
+    Json expect_dup;
+    expect_dup.parse(duplicated);
+    LazyJson dup = Json::lazy_parse(duplicated);
+    EXPECT_EQ(3, dup.find_object_index("c"));
+    EXPECT_EQ(expect_dup.find_object_index("a"), dup.find_object_index("a"));
+    EXPECT_EQ(0, dup.find_object_index("a"));
+    EXPECT_EQ(5, dup.get_object_value(4).get_int64());
+    EXPECT_EQ(1, dup.find_object_index("b"));
+    EXPECT_EQ(-1, dup.find_object_index("d"));
+    EXPECT_EQ(1, dup.get_object_value(dup.find_object_index("a")).get_int64());
+    LazyJson dup_late = Json::lazy_parse(duplicated);
+    EXPECT_EQ(5, dup_late.get_object_value(4).get_int64());
+    EXPECT_EQ(1, dup_late.find_object_index("b"));
+
+    // 下标越界时抛出异常, 不把闭括号当作成员
+    LazyJson bounded = Json::lazy_parse(R"({"a": [1, 2], "b": {}})");
+    LazyJson elements = bounded.get_object_value(0);
+    EXPECT_EQ(2, elements.get_array_element(1).get_int64());
+    EXPECT_THROW(elements.get_array_element(2), json::Exception);
+    EXPECT_THROW(elements.get_array_element(5), json::Exception);
+    EXPECT_EQ(1, elements.get_array_element(0).get_int64());
+    EXPECT_EQ(2, elements.get_array_size());
+    EXPECT_THROW(bounded.get_object_value(2), json::Exception);
+    EXPECT_THROW(bounded.get_object_key(2), json::Exception);
+    EXPECT_THROW(bounded.get_object_value(1).get_object_value(0), json::Exception);
+    EXPECT_EQ("b", bounded.get_object_key(1));
+    EXPECT_EQ(2, bounded.get_object_size());
+
+    // 越过的值与根之后的内容不检查
+    LazyJson partial = Json::lazy_parse(R"({"id": 7, "rest": [1 2 }, "name": "a", "more": )");
+    EXPECT_EQ(7, partial.get_object_value(partial.find_object_index("id")).get_int64());
+    EXPECT_EQ(2, partial.find_object_index("name"));
+    EXPECT_EQ(json::Array, partial.get_object_value(1).get_type());
+    EXPECT_THROW(partial.find_object_index("missing"), json::Exception);
+    EXPECT_THROW(Json(partial.get_object_value(1)), json::Exception);
+    EXPECT_EQ(1, Json::lazy_parse("[1] x").get_array_size());
+    EXPECT_THROW(Json::lazy_parse(" \n "), json::Exception);
+
+    // 访问到的错误与Json::parse相同: 数成员个数时经过所有的键与分隔符, 构造Json时检查整个值
+    const char *structures[] = {
+        "{\"a\" 1}", "{\"a\":1 \"b\":2}", "{\"a\":1,}", "{1:2}", "{\"k\xFF\":1}", "{", "{\"a\":",
+        "[1,2", "[1,]", "[1,,2]", "[", "[}", "{]", "{\"a\":\"abc", "{\"a\":[1,{\"b\":2]", "[\"\\\"]"
+    };
+    for (const char *content : structures) {
+        std::string status, message;
+        Json().parse(content, status);
+        try {
+            LazyJson v = Json::lazy_parse(content);
+            if (v.get_type() == json::Array)
+                v.get_array_size();
+            else
+                v.get_object_size();
+        } catch (const json::Exception &msg) {
+            message = msg.what();
+        }
+        EXPECT_EQ(status, message) << content;
+    }
+    const char *values[] = {"[\"\xFF\"]", "[tru]", "[1e999]", "[\"\\x\"]", "[[1 2]]", "[{\"a\":1,}]"};
+    for (const char *content : values) {
+        std::string status, message;
+        Json().parse(content, status);
+        try {
+            Json(Json::lazy_parse(content).get_array_element(0));
+        } catch (const json::Exception &msg) {
+            message = msg.what();
+        }
+        EXPECT_EQ(status, message) << content;
+    }
+}
+
+// 投影解析只构造路径选中的子树; 不构造的部分默认与Json::parse一样检查
+void TestJson::TestProjection() {
+    std::string content = R"({"user":{"id":42,"name":"lwy","tags":["a","b"]},)"
+                          R"("items":[{"price":1.5,"sku":"x"},{"sku":"y","price":2},{"price":{"amount":3}},7],)"
+                          R"("meta":{"ts":1},"a/b":1,"c~d":2})";
+    struct Case {
+        std::vector<std::string> paths;
+        std::string expect;
+    } cases[] = {
+        {{"/user/id", "/items/*/price"}, R"({"user":{"id":42},"items":[{"price":1.5},{"price":2},{"price":{"amount":3}}]})"},
+        {{"/user"}, R"({"user":{"id":42,"name":"lwy","tags":["a","b"]}})"},
+        {{"/user/id", "/user"}, R"({"user":{"id":42,"name":"lwy","tags":["a","b"]}})"},
+        {{"/items/1/sku", "/items/*/price"}, R"({"items":[{"price":1.5},{"sku":"y","price":2},{"price":{"amount":3}}]})"},
+        {{"/items/3", "/user/tags/1"}, R"({"user":{"tags":["b"]},"items":[7]})"},
+        {{"/a~1b", "/c~0d"}, R"({"a/b":1,"c~d":2})"},
+        {{"/user/id/x", "/missing"}, R"({"user":{}})"},
+        {{}, "{}"},
+        {{""}, content},
+    };
+    for (const Case &c : cases) {
+        JsonProjection projection(c.paths);
+        Json expect;
+        expect.parse(c.expect);
+        for (json::parse_mode mode : {json::Recursive, json::UncheckedSkip}) {
+            Json v;
+            v.parse(content, projection, mode);
+            EXPECT_EQ(expect, v) << c.expect;
+        }
+    }
+    // 成员保持文档中的顺序
+    Json items;
+    items.parse(content, JsonProjection({"/items/1/sku", "/items/*/price"}));
+    Json second = items.get_object_value(0).get_array_element(1);
+    EXPECT_EQ("sku", second.get_object_key(0));
+    EXPECT_EQ("price", second.get_object_key(1));
+
+    // 编译一次, 用于多个文档
+    std::string corpus = MakeCorpus(50);
+    Json records;
+    records.parse(corpus);
+    JsonProjection ids({"/*/id", "/*/geo/lat"});
+    Json v;
+    v.parse(corpus, ids);
+    ASSERT_EQ(50, v.get_array_size());
+    for (size_t i = 0; i < 50; ++i) {
+        Json record = v.get_array_element(i);
+        EXPECT_EQ(2, record.get_object_size());
+        EXPECT_EQ(i, record.get_object_value(record.find_object_index("id")).get_uint64());
+        EXPECT_EQ(31.2304, record.get_object_value(record.find_object_index("geo")).get_object_value(0).get_number());
+    }
+    v.parse("[{\"id\":1,\"x\":[]},{\"y\":2}]", ids);
+    EXPECT_EQ(2, v.get_array_size());
+    EXPECT_EQ(0, v.get_array_element(1).get_object_size());
+
+    const char *pointers[] = {"user", "/a~2", "/a~"};
+    for (const char *pointer : pointers)
+        EXPECT_THROW(JsonProjection({pointer}), json::Exception) << pointer;
+
+    // 默认检查整个文档, 错误码与位置都与Json::parse相同
+    JsonProjection projection({"/a", "/b/*/c"});
+    const char *invalid[] = {
+        "{\"a\":1,\"z\":[1 2]}", "{\"z\":{\"k\" 1},\"a\":1}", "{\"b\":[{\"c\":tru}]}", "{\"b\":[{\"c\":1,}]}",
+        "{\"a\":1} x", "{\"a\":1,}", "{\"a\" 1}", "{\"a\":1 \"b\":2}", "{\"b\":[1,]}", "{\"b\":[1 2]}", "{\"z\":\"\xFF\"}",
+        "{\"a\":\"\\x\"}", "{\"z\":[\"abc]}", "  ", "{\"a\":[1,{\"b\":2]}", "{\"a\":1e999}", "[1,,2]"
+    };
+    for (const char *content : invalid) {
+        ParseResult expect, result;
+        Json().parse(content, expect);
+        v.parse(content, std::strlen(content), projection, result);
+        EXPECT_EQ(expect.get_code(), result.get_code()) << content;
+        EXPECT_EQ(expect.get_offset(), result.get_offset()) << content;
+        EXPECT_EQ(json::Null, v.get_type());
+        EXPECT_THROW(v.parse(content, projection), json::Exception);
+    }
+    // 只按括号配对越过时不检查不构造的值, 但路径上的结构与选中的值仍然检查
+    v.parse("{\"a\":1,\"z\":[1 2 }, \"y\": tru, \"w\": \"\xFF\"}", projection, json::UncheckedSkip);
+    Json expect;
+    expect.parse("{\"a\":1}");
+    EXPECT_EQ(expect, v);
+    ParseResult result;
+    v.parse("{\"a\":1,\"z\":[1 2}", 15, projection, result, json::UncheckedSkip);
+    EXPECT_EQ(json::MissCommaOrSquareBracket, result.get_code());
+    v.parse("{\"a\":tru,\"z\":1}", 15, projection, result, json::UncheckedSkip);
+    EXPECT_EQ(json::InvalidValue, result.get_code());
+    v.parse("{\"z\":1 \"a\":1}", 13, projection, result, json::UncheckedSkip);
+    EXPECT_EQ(json::MissCommaOrCurlyBracket, result.get_code());
+    EXPECT_EQ(7, result.get_offset());
+    v.parse("{\"z\":\"\xFF\",\"a\":2}", 15, projection, result, json::TrustedUtf8);
+    EXPECT_TRUE(result);
+}
+
+// 要找的键都出现后立即结束, 之后的内容不检查
+void TestJson::TestStopWhenFound() {
+    std::string head = R"({"route":"orders","meta":{"tenant":7,"trace":"x"},"body":[1,2,3])";
+    JsonProjection projection({"/route", "/meta/tenant"});
+    Json expect;
+    expect.parse(R"({"route":"orders","meta":{"tenant":7}})");
+    // 后面的内容不完整或不合法都不影响结果, 后面重复的键也不再读取
+    struct Tail {
+        const char *content;
+        bool valid;
+    } tails[] = {{"}", true}, {",\"route\":\"other\"}", true}, {",\"x\":", false}, {",\"x\":[1 2", false},
+                 {" garbage", false}};
+    for (const Tail &tail : tails) {
+        std::string content = head + tail.content;
+        Json v;
+        v.parse(content, projection, json::StopWhenFound);
+        EXPECT_EQ(expect, v) << content;
+        EXPECT_EQ(1, v.find_object_index("meta"));
+        ParseResult result;
+        v.parse(content.data(), content.size(), projection, result);
+        EXPECT_EQ(tail.valid, static_cast<bool>(result)) << content;
+    }
+    // 键出现在不合法的内容之后, 或有键没有出现时, 照常报告错误
+    struct Case {
+        std::string content;
+        json::error_code code;
+    } cases[] = {
+        {R"({"body":[1 2],"route":"a","meta":{"tenant":1}})", json::MissCommaOrSquareBracket},
+        {R"({"route" "a","meta":{"tenant":1}})", json::MissColon},
+        {R"({"route":"a","meta":{"tenant":1,}})", json::MissKey},
+        {R"({"route":"a","body":[1 2]})", json::MissCommaOrSquareBracket},
+        {R"({"route":"a"} x)", json::RootNotSingular},
+    };
+    for (const Case &c : cases) {
+        Json v;
+        ParseResult result;
+        v.parse(c.content.data(), c.content.size(), projection, result, json::StopWhenFound);
+        EXPECT_EQ(c.code, result.get_code()) << c.content;
+        EXPECT_EQ(json::Null, v.get_type());
+    }
+    // 路径对应的值不是容器时不保留, 但也算找到; 根不是对象, 或路径以"*"开头时读完整个文档
+    Json v;
+    v.parse(R"({"meta":1,"route":"a"} x)", projection, json::StopWhenFound);
+    EXPECT_EQ(1, v.get_object_size());
+    ParseResult result;
+    v.parse("[{\"route\":1}] x", 15, projection, result, json::StopWhenFound);
+    EXPECT_EQ(json::RootNotSingular, result.get_code());
+    v.parse("{\"a\":{\"route\":1}} x", 19, JsonProjection({"/*/route"}), result, json::StopWhenFound);
+    EXPECT_EQ(json::RootNotSingular, result.get_code());
+    // 与UncheckedSkip组合时, 结束之前不需要的值也只按括号配对越过
+    v.parse(R"({"body":[1 2],"route":"a","meta":{"tenant":1},)", projection, json::StopWhenFound | json::UncheckedSkip);
+    EXPECT_EQ(2, v.get_object_size());
+}
+
+void TestJson::TestRef() {
+    Json v;
+    v.parse(R"({"a":[1,{"b":[]}],"s":"x"})");
+    JsonRef b = v.ref().get_object_value(0).get_array_element(1).get_object_value(0);
+    Json e;
+    e.set_number(7);
+    b.pushback_array_element(e);
+    b.pushback_array_element(std::move(e));
+    v.ref().get_object_value(1).set_string("y");
+    v.ref().get_object_value(0).get_array_element(0).set_boolean(true);
+
+    std::string content;
+    v.stringify(content);
+    EXPECT_EQ(R"({"a":[true,{"b":[7,7]}],"s":"y"})", content);
+
+    Json n;
+    n.parse("[null]");
+    v.ref().get_object_value(0).set_value(std::move(n));
+    EXPECT_EQ(json::Null, n.get_type());
+    JsonView view = v.ref();
+    EXPECT_EQ(1, view.get_object_value(0).get_array_size());
+    EXPECT_EQ(json::Null, view.get_object_value(0).get_array_element(0).get_type());
+
+    // 用所在树自身赋值: 根赋给根, 以及根赋给自己的子结点
+    Json root;
+    root.parse(R"({"k":"abc"})");
+    root.ref().set_value(root);
+    content.clear();
+    root.stringify(content);
+    EXPECT_EQ(R"({"k":"abc"})", content);
+    root.ref().set_value(std::move(root));
+    content.clear();
+    root.stringify(content);
+    EXPECT_EQ(R"({"k":"abc"})", content);
+
+    root.parse(R"([1,"s"])");
+    root.ref().get_array_element(0).set_value(root);
+    content.clear();
+    root.stringify(content);
+    EXPECT_EQ(R"([[1,"s"],"s"])", content);
+    root.ref().get_array_element(1).set_value(std::move(root));
+    content.clear();
+    root.stringify(content);
+    EXPECT_EQ(R"([[1,"s"],[[1,"s"],"s"]])", content);
+}
+
+// 多次解析取最短耗时, 返回单位为纳秒
+double TestJson::BenchParse(const std::string& content, int repeat) {
+    double best = 0;
+    for (int r = 0; r < repeat; ++r) {
+        Json v;
+        auto start = std::chrono::steady_clock::now();
+        v.parse(content);
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+    return best;
+}
+
+// 深层嵌套的数组, 每层带几个数字; 每个结点只构造一次时, 单个结点的耗时不随深度增长
+void TestJson::BenchParseDeepNesting() {
+    double per_node[4];
+    int depths[4] = {500, 1000, 2000, 4000};
+    for (int k = 0; k < 4; ++k) {
+        std::string content;
+        for (int i = 0; i < depths[k]; ++i)
+            content += "[1,2,3,";
+        content += "null";
+        for (int i = 0; i < depths[k]; ++i)
+            content += ']';
+        double ns = BenchParse(content, 5);
+        per_node[k] = ns / (depths[k] * 4);
+        printf("[ BENCH    ] nested depth %5d: %10.0f ns, %6.2f ns/node\n", depths[k], ns, per_node[k]);
+    }
+    // 若每层都拷贝子树, 耗时为 O(size * depth), 深度翻三倍后单结点耗时约为8倍; 计时受机器负载影响, 只打印不断言
+    printf("[ BENCH    ] ns/node at depth %d / depth %d: %.2f\n", depths[3], depths[0], per_node[3] / per_node[0]);
+}
+
+// 元素只移动不拷贝时, 扩容的代价与元素子树大小无关
+void TestJson::BenchBuildArray() {
+    const int n = 1000000;
+    Json a, e;
+    a.set_array();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) {
+        e.set_number(i);
+        a.pushback_array_element(std::move(e));
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("[ BENCH    ] build array of %d elements: %8.2f ms\n", n, ms);
+    EXPECT_EQ(static_cast<size_t>(n), a.get_array_size());
+}
+
+// 对比通过拷贝访问接口与JsonView遍历同一个二维数组的耗时
+void TestJson::BenchWalkArray() {
+    std::string content = "[";
+    for (int i = 0; i < 200; ++i) {
+        content += i ? ",[" : "[";
+        for (int j = 0; j < 200; ++j)
+            content += j ? ",1" : "1";
+        content += ']';
+    }
+    content += ']';
+    Json v;
+    v.parse(content);
+
+    double sum_copy = 0, sum_view = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < v.get_array_size(); ++i) {
+        Json row = v.get_array_element(i);
+        for (size_t j = 0; j < row.get_array_size(); ++j)
+            sum_copy += row.get_array_element(j).get_number();
+    }
+    auto mid = std::chrono::steady_clock::now();
+    JsonView root = v.view();
+    for (size_t i = 0; i < root.get_array_size(); ++i) {
+        JsonView row = root.get_array_element(i);
+        for (size_t j = 0; j < row.get_array_size(); ++j)
+            sum_view += row.get_array_element(j).get_number();
+    }
+    auto end = std::chrono::steady_clock::now();
+    printf("[ BENCH    ] walk 200x200 array: copy %8.3f ms, view %8.3f ms\n",
+           std::chrono::duration<double, std::milli>(mid - start).count(),
+           std::chrono::duration<double, std::milli>(end - mid).count());
+    EXPECT_DOUBLE_EQ(sum_copy, sum_view);
+}
+
+// 通过set_object_value逐个插入键, 有索引时总耗时随键数线性增长
+void TestJson::BenchBuildObject() {
+    const int n = 50000;
+    std::vector<std::string> keys;
+    for (int i = 0; i < n; ++i)
+        keys.push_back("id_" + std::to_string(i * 7919));
+    Json o, v;
+    o.set_object();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) {
+        v.set_number(i);
+        o.set_object_value(keys[i], v);
+    }
+    long long found = 0;
+    for (int i = 0; i < n; ++i)
+        found += o.find_object_index(keys[i]) == i;
+    auto end = std::chrono::steady_clock::now();
+    printf("[ BENCH    ] build and look up object of %d keys: %8.2f ms\n", n,
+           std::chrono::duration<double, std::milli>(end - start).count());
+    EXPECT_EQ(n, found);
+}
+
+// 把紧凑的JSON串缩进成每层4个空格的格式
+std::string TestJson::Indent(const std::string& content) {
+    std::string res;
+    int depth = 0;
+    bool in_string = false;
+    for (size_t i = 0; i < content.size(); ++i) {
+        char ch = content[i];
+        if (in_string) {
+            res += ch;
+            if (ch == '\\')
+                res += content[++i];
+            else if (ch == '\"')
+                in_string = false;
+            continue;
+        }
+        switch (ch) {
+            case '"': in_string = true; res += ch; break;
+            case '{': case '[': res += ch; res += '\n'; res.append(4 * ++depth, ' '); break;
+            case '}': case ']': res += '\n'; res.append(4 * --depth, ' '); res += ch; break;
+            case ',': res += ",\n"; res.append(4 * depth, ' '); break;
+            case ':': res += ": "; break;
+            default: res += ch;
+        }
+    }
+    return res;
+}
+
+// 由若干条记录组成的典型文档
+std::string TestJson::MakeCorpus(int records) {
+    std::string content = "[";
+    for (int i = 0; i < records; ++i) {
+        if (i) content += ',';
+        content += R"({"id":)" + std::to_string(i) +
+                   R"(,"name":"record )" + std::to_string(i) +
+                   R"(","active":true,"score":)" + std::to_string(i * 0.25) +
+                   R"(,"tags":["alpha","beta","gamma"],"geo":{"lat":31.2304,"lng":121.4737},"parent":null})";
+    }
+    return content + "]";
+}
+
+// 同一文档紧凑与缩进两种格式的解析吞吐
+void TestJson::BenchParseIndented() {
+    std::string minified = MakeCorpus(5000);
+    std::string indented = Indent(minified);
+    Json a, b;
+    a.parse(minified);
+    b.parse(indented);
+    EXPECT_EQ(1, int(a == b));
+    double ns_min = BenchParse(minified, 5);
+    double ns_ind = BenchParse(indented, 5);
+    printf("[ BENCH    ] parse minified %7.2f MB: %8.2f MB/s\n", minified.size() / 1e6, minified.size() * 1e3 / ns_min);
+    printf("[ BENCH    ] parse indented %7.2f MB: %8.2f MB/s\n", indented.size() / 1e6, indented.size() * 1e3 / ns_ind);
+}
+
+// 由长ASCII字符串组成的文档的解析吞吐, 分无转义与少量转义两种
+void TestJson::BenchParseLongStrings() {
+    std::string plain(200, 'x'), escaped(200, 'x');
+    for (size_t i = 50; i < escaped.size(); i += 50)
+        escaped[i] = '\t';
+    Json a, b;
+    a.set_array();
+    b.set_array();
+    for (int i = 0; i < 5000; ++i) {
+        Json e;
+        e.set_string(plain);
+        a.pushback_array_element(std::move(e));
+        e.set_string(escaped);
+        b.pushback_array_element(std::move(e));
+    }
+    std::string content_plain, content_escaped;
+    a.stringify(content_plain);
+    b.stringify(content_escaped);
+    double ns_plain = BenchParse(content_plain, 5);
+    double ns_escaped = BenchParse(content_escaped, 5);
+    printf("[ BENCH    ] parse long strings without escapes: %8.2f MB/s\n", content_plain.size() * 1e3 / ns_plain);
+    printf("[ BENCH    ] parse long strings with escapes:    %8.2f MB/s\n", content_escaped.size() * 1e3 / ns_escaped);
+}
+
+// 以坐标为主的数字密集型文档的解析吞吐
+void TestJson::BenchParseNumbers() {
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> lat(-90, 90), lng(-180, 180);
+    std::string content = "[";
+    char buffer[64];
+    for (int i = 0; i < 50000; ++i) {
+        snprintf(buffer, sizeof(buffer), "%s[%.7f,%.7f]", i ? "," : "", lng(rng), lat(rng));
+        content += buffer;
+    }
+    content += ']';
+    double ns = BenchParse(content, 5);
+    printf("[ BENCH    ] parse coordinates %6.2f MB: %8.2f MB/s, %6.2f ns/number\n",
+           content.size() / 1e6, content.size() * 1e3 / ns, ns / 100000);
+}
+
+// 64位ID组成的整数密集型文档的解析与序列化
+void TestJson::BenchIntegers() {
+    std::mt19937_64 rng(2);
+    std::string content = "[";
+    for (int i = 0; i < 100000; ++i) {
+        if (i) content += ',';
+        content += std::to_string(rng() >> (i % 40));
+    }
+    content += ']';
+    double ns = BenchParse(content, 5);
+    Json v;
+    v.parse(content);
+    std::string out;
+    auto start = std::chrono::steady_clock::now();
+    v.stringify(out);
+    auto end = std::chrono::steady_clock::now();
+    EXPECT_EQ(content, out);
+    printf("[ BENCH    ] parse integers %6.2f MB: %8.2f MB/s, stringify: %8.2f MB/s\n", content.size() / 1e6,
+           content.size() * 1e3 / ns, content.size() * 1e3 / std::chrono::duration<double, std::nano>(end - start).count());
+}
+
+// 随机double的序列化吞吐, 与原先的 %.17g 比较
+void TestJson::BenchStringifyDoubles() {
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    Json v;
+    v.set_array();
+    for (int i = 0; i < 100000; ++i) {
+        Json e;
+        e.set_number(i % 2 ? dist(rng) : static_cast<double>(static_cast<float>(dist(rng))));
+        v.pushback_array_element(std::move(e));
+    }
+    std::string out;
+    auto start = std::chrono::steady_clock::now();
+    v.stringify(out);
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+    std::string ref = "[";
+    char buffer[32];
+    JsonView view = v.view();
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < view.get_array_size(); ++i) {
+        if (i) ref += ',';
+        snprintf(buffer, sizeof(buffer), "%.17g", view.get_array_element(i).get_number());
+        ref += buffer;
+    }
+    ref += ']';
+    end = std::chrono::steady_clock::now();
+    double ns_ref = std::chrono::duration<double, std::nano>(end - start).count();
+
+    Json w;
+    w.parse(out);
+    EXPECT_TRUE(v == w);
+    printf("[ BENCH    ] stringify doubles: %6.2f ns/number, %6.2f MB (%%.17g: %6.2f ns/number, %6.2f MB)\n",
+           ns / 100000, out.size() / 1e6, ns_ref / 100000, ref.size() / 1e6);
+}
+
+// 长字符串的序列化吞吐: 解析得到的字符串(已知无需转义), 手工设置的字符串, 以及带转义的字符串
+void TestJson::BenchStringifyLongStrings() {
+    std::string plain(200, 'x'), escaped(200, 'x');
+    for (size_t i = 50; i < escaped.size(); i += 50)
+        escaped[i] = '\t';
+    Json a, b;
+    a.set_array();
+    b.set_array();
+    for (int i = 0; i < 5000; ++i) {
+        Json e;
+        e.set_string(plain);
+        a.pushback_array_element(std::move(e));
+        e.set_string(escaped);
+        b.pushback_array_element(std::move(e));
+    }
+    std::string content;
+    a.stringify(content);
+    Json parsed;
+    parsed.parse(content);
+    const Json *docs[] = {&parsed, &a, &b};
+    const char *names[] = {"parsed", "plain ", "escaped"};
+    for (int i = 0; i < 3; ++i) {
+        std::string out;
+        double best = 1e30;
+        for (int r = 0; r < 5; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            docs[i]->stringify(out);
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        printf("[ BENCH    ] stringify long strings, %s: %8.2f MB/s\n", names[i], out.size() * 1e3 / best);
+    }
+}
+
+// 综合文档的序列化吞吐
+void TestJson::BenchStringifyCorpus() {
+    Json v;
+    v.parse(MakeCorpus(20000));
+    std::string out;
+    double best = 1e30;
+    for (int r = 0; r < 5; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        v.stringify(out);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    printf("[ BENCH    ] stringify corpus %6.2f MB: %8.2f MB/s\n", out.size() / 1e6, out.size() * 1e3 / best);
+}
+
+// 按请求解析-序列化-丢弃的循环: 每次新建Json, 与复用同一个Document比较
+void TestJson::BenchDocumentLoop() {
+    std::string content = MakeCorpus(2000), out, expect;
+    const int loops = 50;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < loops; ++i) {
+        Json v;
+        v.parse(content);
+        v.stringify(out);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns_json = std::chrono::duration<double, std::nano>(end - start).count() / loops;
+    Document d;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < loops; ++i) {
+        d.parse(content);
+        d.stringify(out);
+    }
+    end = std::chrono::steady_clock::now();
+    double ns_doc = std::chrono::duration<double, std::nano>(end - start).count() / loops;
+    Json v;
+    v.parse(content);
+    v.stringify(expect);
+    EXPECT_EQ(expect, out);
+    printf("[ BENCH    ] parse+stringify %5.2f MB: Json %7.3f ms, Document %7.3f ms\n",
+           content.size() / 1e6, ns_json / 1e6, ns_doc / 1e6);
+}
+
+size_t TestJson::CountNodes(const DocumentView &v) {
+    size_t count = 1;
+    if (v.get_type() == json::Array) {
+        for (size_t i = 0; i < v.get_array_size(); ++i)
+            count += CountNodes(v.get_array_element(i));
+    } else if (v.get_type() == json::Object) {
+        for (size_t i = 0; i < v.get_object_size(); ++i)
+            count += CountNodes(v.get_object_value(i));
+    }
+    return count;
+}
+
+// 对Value树, Document与磁带各做一次完整遍历(累加所有数字, 统计字符串长度)与序列化
+static double SumValues(const JsonView &v, size_t &chars) {
+    switch (v.get_type()) {
+        case json::Number: return v.get_number();
+        case json::String: chars += v.get_string().size(); return 0;
+        case json::Array: {
+            double sum = 0;
+            for (size_t i = 0; i < v.get_array_size(); ++i)
+                sum += SumValues(v.get_array_element(i), chars);
+            return sum;
+        }
+        case json::Object: {
+            double sum = 0;
+            for (size_t i = 0; i < v.get_object_size(); ++i)
+                sum += SumValues(v.get_object_value(i), chars);
+            return sum;
+        }
+        default: return 0;
+    }
+}
+
+static double SumValues(const DocumentView &v, size_t &chars) {
+    switch (v.get_type()) {
+        case json::Number: return v.get_number();
+        case json::String: chars += v.get_string_length(); return 0;
+        case json::Array: {
+            double sum = 0;
+            for (size_t i = 0; i < v.get_array_size(); ++i)
+                sum += SumValues(v.get_array_element(i), chars);
+            return sum;
+        }
+        case json::Object: {
+            double sum = 0;
+            for (size_t i = 0; i < v.get_object_size(); ++i)
+                sum += SumValues(v.get_object_value(i), chars);
+            return sum;
+        }
+        default: return 0;
+    }
+}
+
+static double SumValues(const TapeView &v, size_t &chars) {
+    switch (v.get_type()) {
+        case json::Number: return v.get_number();
+        case json::String: chars += v.get_string_length(); return 0;
+        case json::Array: case json::Object: {
+            double sum = 0;
+            for (TapeView e : v)
+                sum += SumValues(e, chars);
+            return sum;
+        }
+        default: return 0;
+    }
+}
+
+template <typename View>
+static double BenchTraverseView(const View &root, double &sum, size_t &chars) {
+    double best = 1e30;
+    for (int r = 0; r < 5; ++r) {
+        chars = 0;
+        auto start = std::chrono::steady_clock::now();
+        sum = SumValues(root, chars);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    return best;
+}
+
+template <typename Doc>
+static double BenchStringifyDoc(const Doc &doc, std::string &out) {
+    double best = 1e30;
+    for (int r = 0; r < 5; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        doc.stringify(out);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    return best;
+}
+
+void TestJson::BenchTraverse() {
+    std::string content = MakeCorpus(20000);
+    Json v;
+    v.parse(content);
+    Document d;
+    d.parse(content);
+    Tape t;
+    t.parse(content);
+
+    double sums[3];
+    size_t chars[3];
+    double ns_json = BenchTraverseView(v.view(), sums[0], chars[0]);
+    double ns_doc = BenchTraverseView(d.view(), sums[1], chars[1]);
+    double ns_tape = BenchTraverseView(t.view(), sums[2], chars[2]);
+    EXPECT_DOUBLE_EQ(sums[0], sums[1]);
+    EXPECT_DOUBLE_EQ(sums[0], sums[2]);
+    EXPECT_EQ(chars[0], chars[1]);
+    EXPECT_EQ(chars[0], chars[2]);
+    printf("[ BENCH    ] traverse %5.2f MB: Json %7.3f ms, Document %7.3f ms, Tape %7.3f ms\n",
+           content.size() / 1e6, ns_json / 1e6, ns_doc / 1e6, ns_tape / 1e6);
+
+    std::string out[3];
+    ns_json = BenchStringifyDoc(v, out[0]);
+    ns_doc = BenchStringifyDoc(d, out[1]);
+    ns_tape = BenchStringifyDoc(t, out[2]);
+    EXPECT_EQ(out[0], out[1]);
+    EXPECT_EQ(out[0], out[2]);
+    printf("[ BENCH    ] stringify %5.2f MB: Json %7.3f ms, Document %7.3f ms, Tape %7.3f ms\n",
+           content.size() / 1e6, ns_json / 1e6, ns_doc / 1e6, ns_tape / 1e6);
+}
+
+// 只取出少数字段时, 事件驱动解析与构造整棵Value树的比较
+void TestJson::BenchSax() {
+    std::string content = MakeCorpus(20000);
+    double ns_sax = 1e30, ns_json = 1e30;
+    size_t count = 0;
+    for (int r = 0; r < 5; ++r) {
+        IdCollector ids;
+        auto start = std::chrono::steady_clock::now();
+        sax_parse(content, ids);
+        auto end = std::chrono::steady_clock::now();
+        ns_sax = std::min(ns_sax, std::chrono::duration<double, std::nano>(end - start).count());
+        count = ids.ids.size();
+
+        start = std::chrono::steady_clock::now();
+        Json v;
+        v.parse(content);
+        for (size_t i = 0; i < v.view().get_array_size(); ++i)
+            v.view().get_array_element(i).get_object_value(0).get_int64();
+        end = std::chrono::steady_clock::now();
+        ns_json = std::min(ns_json, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    EXPECT_EQ(20000u, count);
+    printf("[ BENCH    ] pick ids from %5.2f MB: sax %8.2f MB/s, Json %8.2f MB/s\n",
+           content.size() / 1e6, content.size() * 1e3 / ns_sax, content.size() * 1e3 / ns_json);
+}
+
+// 按64KB分块增量解析, 与先拼接完整再一次性解析比较
+void TestJson::BenchPush() {
+    std::string content = MakeCorpus(20000);
+    const size_t chunk = 64 * 1024;
+    double ns_whole = 1e30, ns_push = 1e30;
+    for (int r = 0; r < 5; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::string buffered;
+            for (size_t i = 0; i < content.size(); i += chunk)
+                buffered.append(content, i, chunk);
+            Json v;
+            v.parse(buffered);
+        }
+        auto end = std::chrono::steady_clock::now();
+        ns_whole = std::min(ns_whole, std::chrono::duration<double, std::nano>(end - start).count());
+
+        start = std::chrono::steady_clock::now();
+        {
+            Json v;
+            JsonPushParser parser(v);
+            for (size_t i = 0; i < content.size(); i += chunk)
+                parser.feed(content.data() + i, std::min(chunk, content.size() - i));
+            parser.finish();
+        }
+        end = std::chrono::steady_clock::now();
+        ns_push = std::min(ns_push, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    printf("[ BENCH    ] parse %5.2f MB in 64KB chunks: buffered %8.2f MB/s, push %8.2f MB/s\n",
+           content.size() / 1e6, content.size() * 1e3 / ns_whole, content.size() * 1e3 / ns_push);
+}
+
+// 每行一条MakeCorpus中的记录
+std::string TestJson::MakeNdjson(int records) {
+    Json v;
+    v.parse(MakeCorpus(records));
+    std::string content, line;
+    for (size_t i = 0; i < v.get_array_size(); ++i) {
+        v.view().get_array_element(i).stringify(line);
+        content += line;
+        content += '\n';
+    }
+    return content;
+}
+
+// 线程数从1开始倍增时的吞吐, 理想情况下接近线性增长
+void TestJson::BenchNdjson() {
+    std::string content = MakeNdjson(40000);
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<JsonLine> results;
+    for (size_t threads = 1; threads <= std::max(4u, hardware); threads *= 2) {
+        NdjsonReader reader(threads);
+        double best = 1e30;
+        for (int r = 0; r < 3; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            reader.parse(content, results);
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        EXPECT_EQ(40000u, results.size());
+        printf("[ BENCH    ] ndjson %5.2f MB, %2zu threads (%u cores): %8.2f MB/s\n",
+               content.size() / 1e6, threads, hardware, content.size() * 1e3 / best);
+    }
+}
+
+// 第一阶段各指令集建立结构索引的速度
+void TestJson::BenchIndexed() {
+    std::string corpora[] = {MakeCorpus(20000), Indent(MakeCorpus(5000)), MakeConfig(20000)};
+    const char *names[] = {"records ", "indented", "config  "};
+    const char *levels[] = {"scalar", "sse2", "ssse3", "avx2"};
+    for (int i = 0; i < 3; ++i) {
+        const std::string &content = corpora[i];
+        std::vector<uint32_t> index;
+        for (int level = json::simd_scalar; level <= json::detect_simd_level(); ++level) {
+            double best = 1e30;
+            for (int r = 0; r < 5; ++r) {
+                auto start = std::chrono::steady_clock::now();
+                json::build_structural_index(content.data(), content.size(), index, level);
+                auto end = std::chrono::steady_clock::now();
+                best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+            }
+            printf("[ BENCH    ] %s %5.2f MB stage 1 %-6s: %8.2f MB/s\n",
+                   names[i], content.size() / 1e6, levels[level], content.size() * 1e3 / best);
+        }
+    }
+}
+
+// 先读入std::string再解析, 与映射文件后直接解析的比较
+void TestJson::BenchParseFile() {
+    std::string path = testing::TempDir() + "lwy_json_bench_file.json";
+    std::string content = MakeCorpus(40000);
+    std::ofstream(path, std::ios::binary) << content;
+    double ns_read = 1e30, ns_map = 1e30;
+    for (int r = 0; r < 5; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            Json v;
+            v.parse(text);
+        }
+        auto end = std::chrono::steady_clock::now();
+        ns_read = std::min(ns_read, std::chrono::duration<double, std::nano>(end - start).count());
+
+        start = std::chrono::steady_clock::now();
+        {
+            Json v;
+            v.parse_file(path);
+        }
+        end = std::chrono::steady_clock::now();
+        ns_map = std::min(ns_map, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    std::remove(path.c_str());
+    printf("[ BENCH    ] parse %5.2f MB file: read into string %8.2f MB/s, parse_file %8.2f MB/s\n",
+           content.size() / 1e6, content.size() * 1e3 / ns_read, content.size() * 1e3 / ns_map);
+}
+
+// 短小的非法消息: 抛出并捕获Exception与返回错误码的开销比较
+void TestJson::BenchErrors() {
+    std::vector<std::string> messages;
+    for (int i = 0; i < 1000; ++i)
+        messages.push_back(R"({"id":)" + std::to_string(i) + R"(,"name":"n","tags":["a" "b"]})");
+    const int rounds = 20;
+    double ns_throw = 1e30, ns_code = 1e30;
+    size_t failures = 0;
+    for (int r = 0; r < 3; ++r) {
+        Json v;
+        auto start = std::chrono::steady_clock::now();
+        for (int k = 0; k < rounds; ++k) {
+            for (const std::string &m : messages) {
+                try {
+                    v.parse(m);
+                } catch (const json::Exception &) {
+                    ++failures;
+                }
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        ns_throw = std::min(ns_throw, std::chrono::duration<double, std::nano>(end - start).count());
+
+        ParseResult result;
+        start = std::chrono::steady_clock::now();
+        for (int k = 0; k < rounds; ++k) {
+            for (const std::string &m : messages) {
+                v.parse(m, result);
+                failures += !result;
+            }
+        }
+        end = std::chrono::steady_clock::now();
+        ns_code = std::min(ns_code, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    EXPECT_EQ(6u * rounds * messages.size(), failures);
+    double count = double(rounds) * messages.size();
+    printf("[ BENCH    ] malformed messages: exception %7.1f ns/message, error code %7.1f ns/message\n",
+           ns_throw / count, ns_code / count);
+}
+
+// 只做校验与完整解析的吞吐, 以及单独的UTF-8校验在各指令集上的速度
+void TestJson::BenchValidate() {
+    std::string text;
+    for (int i = 0; i < 20000; ++i) {
+        if (i) text += ',';
+        text += "{\"id\":" + std::to_string(i) + ",\"title\":\"\xE6\xB5\x8B\xE8\xAF\x95\xE6\x95\xB0\xE6\x8D\xAE "
+                + std::to_string(i) + "\",\"note\":\"caf\xC3\xA9 \xF0\x9F\x98\x80 na\xC3\xAFve r\xC3\xA9sum\xC3\xA9\"}";
+    }
+    std::string corpora[] = {MakeCorpus(20000), MakeConfig(20000), "[" + text + "]"};
+    const char *names[] = {"records", "config ", "utf-8  "};
+    const char *levels[] = {"scalar", "sse2", "ssse3", "avx2"};
+    for (int i = 0; i < 3; ++i) {
+        const std::string &content = corpora[i];
+        const char *begin = content.data(), *end = begin + content.size();
+        double ns_validate = 1e30, ns_parse = 1e30;
+        for (int r = 0; r < 5; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            ParseResult result = Json::validate(content);
+            auto stop = std::chrono::steady_clock::now();
+            ASSERT_TRUE(result);
+            ns_validate = std::min(ns_validate, std::chrono::duration<double, std::nano>(stop - start).count());
+            Json v;
+            start = std::chrono::steady_clock::now();
+            v.parse(content);
+            stop = std::chrono::steady_clock::now();
+            ns_parse = std::min(ns_parse, std::chrono::duration<double, std::nano>(stop - start).count());
+        }
+        printf("[ BENCH    ] %s %5.2f MB: validate %6.2f GB/s, parse %6.2f GB/s\n",
+               names[i], content.size() / 1e6, content.size() / ns_validate, content.size() / ns_parse);
+        for (int level = json::simd_scalar; level <= json::detect_simd_level(); ++level) {
+            if (level == json::simd_sse2)
+                continue;       // 与标量实现相同
+            double best = 1e30;
+            for (int r = 0; r < 5; ++r) {
+                auto start = std::chrono::steady_clock::now();
+                EXPECT_EQ(end, json::find_invalid_utf8(begin, end, level));
+                auto stop = std::chrono::steady_clock::now();
+                best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count());
+            }
+            printf("[ BENCH    ] %s %5.2f MB: utf-8 check %-6s %6.2f GB/s\n",
+                   names[i], content.size() / 1e6, levels[level], content.size() / best);
+        }
+    }
+}
+
+// 字符串的UTF-8校验占解析时间的比例: 默认校验与TrustedUtf8的吞吐比较
+void TestJson::BenchUtf8Check() {
+    std::string text = "[";
+    for (int i = 0; i < 20000; ++i) {
+        if (i) text += ',';
+        text += "{\"id\":" + std::to_string(i) + ",\"title\":\"\xE6\xB5\x8B\xE8\xAF\x95\xE6\x95\xB0\xE6\x8D\xAE "
+                + std::to_string(i) + "\",\"note\":\"caf\xC3\xA9 \xF0\x9F\x98\x80 na\xC3\xAFve r\xC3\xA9sum\xC3\xA9\"}";
+    }
+    text += "]";
+    std::string corpora[] = {MakeCorpus(20000), MakeConfig(20000), Indent(MakeCorpus(5000)), text};
+    const char *names[] = {"records ", "config  ", "indented", "utf-8   "};
+    for (int i = 0; i < 4; ++i) {
+        const std::string &content = corpora[i];
+        // 交替测量以抵消频率变化, 取各自的最好成绩
+        double ns[4] = {1e30, 1e30, 1e30, 1e30};
+        for (int r = 0; r < 7; ++r) {
+            for (int k = 0; k < 4; ++k) {
+                json::parse_mode mode = k % 2 ? json::TrustedUtf8 : json::Recursive;
+                auto start = std::chrono::steady_clock::now();
+                if (k < 2) {
+                    Json v;
+                    v.parse(content, mode);
+                } else {
+                    Tape t;
+                    t.parse(content, mode);
+                }
+                auto end = std::chrono::steady_clock::now();
+                ns[k] = std::min(ns[k], std::chrono::duration<double, std::nano>(end - start).count());
+            }
+        }
+        printf("[ BENCH    ] %s %5.2f MB: Json checked %7.2f, trusted %7.2f MB/s (%+5.1f%%); "
+               "Tape checked %7.2f, trusted %7.2f MB/s (%+5.1f%%)\n",
+               names[i], content.size() / 1e6,
+               content.size() * 1e3 / ns[0], content.size() * 1e3 / ns[1], (ns[0] / ns[1] - 1) * 100,
+               content.size() * 1e3 / ns[2], content.size() * 1e3 / ns[3], (ns[2] / ns[3] - 1) * 100);
+    }
+}
+
+// 从大文档中读取少数几个字段: 按需访问与完整解析后再查找的耗时
+void TestJson::BenchLazy() {
+    std::string config = MakeConfig(20000);
+    std::string corpus = MakeCorpus(20000);
+    const char *fields[] = {"service-10", "service-9000", "service-19990"};
+    double ns[3] = {1e30, 1e30, 1e30};
+    for (int r = 0; r < 5; ++r) {
+        int64_t sums[3] = {0, 0, 0};
+        auto start = std::chrono::steady_clock::now();
+        LazyJson lazy = Json::lazy_parse(config);
+        for (const char *field : fields) {
+            LazyJson service = lazy.get_object_value(lazy.find_object_index(field));
+            sums[0] += service.get_object_value(service.find_object_index("port")).get_int64();
+        }
+        auto stop = std::chrono::steady_clock::now();
+        ns[0] = std::min(ns[0], std::chrono::duration<double, std::nano>(stop - start).count());
+
+        start = std::chrono::steady_clock::now();
+        Json v;
+        v.parse(config);
+        for (const char *field : fields) {
+            Json service = v.get_object_value(v.find_object_index(field));
+            sums[1] += service.get_object_value(service.find_object_index("port")).get_int64();
+        }
+        stop = std::chrono::steady_clock::now();
+        ns[1] = std::min(ns[1], std::chrono::duration<double, std::nano>(stop - start).count());
+
+        start = std::chrono::steady_clock::now();
+        Tape t;
+        t.parse(config);
+        for (const char *field : fields) {
+            TapeView service = t.view().get_object_value(t.view().find_object_index(field));
+            sums[2] += service.get_object_value(service.find_object_index("port")).get_int64();
+        }
+        stop = std::chrono::steady_clock::now();
+        ns[2] = std::min(ns[2], std::chrono::duration<double, std::nano>(stop - start).count());
+        EXPECT_EQ(8010 + 17000 + 27990, sums[0]);
+        EXPECT_EQ(sums[0], sums[1]);
+        EXPECT_EQ(sums[0], sums[2]);
+    }
+    printf("[ BENCH    ] 3 of 20000 keys (%5.2f MB): lazy %8.1f us, Json %8.1f us, Tape %8.1f us\n",
+           config.size() / 1e6, ns[0] / 1e3, ns[1] / 1e3, ns[2] / 1e3);
+
+    // 数组中按下标访问, 前面的元素整段跳过
+    double lazy_ns = 1e30, json_ns = 1e30;
+    for (int r = 0; r < 5; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        LazyJson lazy = Json::lazy_parse(corpus);
+        LazyJson record = lazy.get_array_element(19999);
+        std::string name = record.get_object_value(record.find_object_index("name")).get_string();
+        auto stop = std::chrono::steady_clock::now();
+        lazy_ns = std::min(lazy_ns, std::chrono::duration<double, std::nano>(stop - start).count());
+        EXPECT_EQ("record 19999", name);
+        start = std::chrono::steady_clock::now();
+        Json v;
+        v.parse(corpus);
+        Json last = v.get_array_element(19999);
+        name = last.get_object_value(last.find_object_index("name")).get_string();
+        stop = std::chrono::steady_clock::now();
+        json_ns = std::min(json_ns, std::chrono::duration<double, std::nano>(stop - start).count());
+        EXPECT_EQ("record 19999", name);
+    }
+    printf("[ BENCH    ] last of 20000 records (%5.2f MB): lazy %8.1f us (%6.2f GB/s), Json %8.1f us\n",
+           corpus.size() / 1e6, lazy_ns / 1e3, corpus.size() / lazy_ns, json_ns / 1e3);
+}
+
+// 只取每条记录的两个字段: 投影解析与完整解析的耗时和结果占用的内存
+void TestJson::BenchProjection() {
+    std::string corpora[] = {MakeCorpus(20000), MakeConfig(20000)};
+    JsonProjection projections[] = {JsonProjection({"/*/id", "/*/geo/lat"}), JsonProjection({"/*/port", "/*/owner"})};
+    const char *names[] = {"records", "config "};
+    for (int i = 0; i < 2; ++i) {
+        const std::string &content = corpora[i];
+        // 依次为完整解析, 检查跳过的部分, 只按括号配对跳过
+        double ns[3] = {1e30, 1e30, 1e30};
+        size_t bytes[3] = {0, 0, 0};
+        for (int r = 0; r < 5; ++r) {
+            for (int k = 0; k < 3; ++k) {
+                size_t before = heap_in_use();
+                Json *v = new Json;
+                auto start = std::chrono::steady_clock::now();
+                if (k == 0)
+                    v->parse(content);
+                else
+                    v->parse(content, projections[i], k == 1 ? json::Recursive : json::UncheckedSkip);
+                auto stop = std::chrono::steady_clock::now();
+                bytes[k] = heap_in_use() - before;
+                delete v;
+                ns[k] = std::min(ns[k], std::chrono::duration<double, std::nano>(stop - start).count());
+            }
+        }
+        printf("[ BENCH    ] projection %s %5.2f MB: full %7.2f MB/s %8zu KB, checked %7.2f MB/s %6zu KB, "
+               "unchecked %7.2f MB/s %6zu KB\n", names[i], content.size() / 1e6,
+               content.size() * 1e3 / ns[0], bytes[0] / 1024, content.size() * 1e3 / ns[1], bytes[1] / 1024,
+               content.size() * 1e3 / ns[2], bytes[2] / 1024);
+    }
+}
+
+// 路由键在最前面的消息: 找到即停止时, 耗时与消息的大小无关
+void TestJson::BenchStopWhenFound() {
+    JsonProjection projection({"/route", "/tenant"});
+    const int records[] = {10, 1000, 100000};
+    for (int n : records) {
+        std::string content = R"({"route":"orders.created","tenant":42,"payload":)" + MakeCorpus(n) + "}";
+        double ns[3] = {1e30, 1e30, 1e30};
+        for (int r = 0; r < 5; ++r) {
+            for (int k = 0; k < 3; ++k) {
+                Json v;
+                auto start = std::chrono::steady_clock::now();
+                if (k == 0)
+                    v.parse(content, projection, json::StopWhenFound);
+                else if (k == 1)
+                    v.parse(content, projection);
+                else
+                    v.parse(content);
+                auto stop = std::chrono::steady_clock::now();
+                ns[k] = std::min(ns[k], std::chrono::duration<double, std::nano>(stop - start).count());
+                EXPECT_EQ("orders.created", v.get_object_value(v.find_object_index("route")).get_string());
+            }
+        }
+        printf("[ BENCH    ] routing key of %9zu B message: stop when found %8.2f us, projection %10.2f us, "
+               "full %10.2f us\n", content.size(), ns[0] / 1e3, ns[1] / 1e3, ns[2] / 1e3);
+    }
+}
+
+// 典型的配置文档: 短键, 短字符串, 小整数与布尔值
+std::string TestJson::MakeConfig(int services) {
+    std::string content = "{";
+    for (int i = 0; i < services; ++i) {
+        if (i) content += ',';
+        std::string id = std::to_string(i);
+        content += "\"service-" + id + R"(":{"host":"10.0.)" + std::to_string(i % 256) + ".1\",\"port\":" +
+                   std::to_string(8000 + i) + R"(,"enabled":true,"timeout_ms":1500,"retries":3,)" +
+                   R"("tags":["prod","zone-a"],"owner":"team-)" + std::to_string(i % 7) + "\"}";
+    }
+    return content + "}";
+}
+
+// 同一文档以Value树与Document结点存储时, 平均每个值占用的内存
+void TestJson::BenchMemoryPerNode() {
+    const char *names[] = {"records", "config ", "numbers"};
+    std::string numbers = "[";
+    for (int i = 0; i < 100000; ++i)
+        numbers += (i ? "," : "") + std::to_string(i * 7);
+    numbers += ']';
+    std::string corpora[] = {MakeCorpus(5000), MakeConfig(5000), numbers};
+    for (int i = 0; i < 3; ++i) {
+        size_t before = heap_in_use();
+        Json *v = new Json;
+        v->parse(corpora[i]);
+        size_t json_bytes = heap_in_use() - before;
+        delete v;
+        Document d;
+        d.parse(corpora[i]);
+        size_t nodes = CountNodes(d.view());
+        Tape t;
+        t.parse(corpora[i]);
+        printf("[ BENCH    ] memory per node, %s (%6zu nodes): Json %6.2f B, Document %6.2f B, Tape %6.2f B\n",
+               names[i], nodes, static_cast<double>(json_bytes) / nodes,
+               static_cast<double>(d.get_memory_usage()) / nodes,
+               static_cast<double>(t.get_memory_usage()) / nodes);
+    }
+}
+
+// 单元测试与性能测试分别编译为Json与JsonBench两个程序, 运行单元测试时不必等待性能测试
+#ifndef JSON_BENCHMARK
 TEST(testParse, literal) {
     TestJson::TestParseLiteral();
 }
@@ -598,6 +3101,14 @@ TEST(testParse, number) {
     TestJson::TestParseNumber();
 }
 
+TEST(testParse, numberExact) {
+    TestJson::TestParseNumberExact();
+}
+
+TEST(testParse, integer) {
+    TestJson::TestParseInteger();
+}
+
 TEST(testParse, string) {
     TestJson::TestParseString();
 }
@@ -646,6 +3157,10 @@ TEST(testParse, invalidUnicodeSurrogate) {
     TestJson::TestParseInvalidUnicodeSurrogate();
 }
 
+TEST(testParse, invalidUtf8) {
+    TestJson::TestParseInvalidUtf8();
+}
+
 TEST(testParse, missCommaOrSquareBracket) {
     TestJson::TestParseMissCommaOrSquareBracket();
 }
@@ -662,6 +3177,18 @@ TEST(testParse, missCommaOrCurlyBracket) {
     TestJson::TestParseMissCommaOrCurlyBracket();
 }
 
+TEST(testParse, whitespace) {
+    TestJson::TestParseWhitespace();
+}
+
+TEST(testParse, longString) {
+    TestJson::TestParseLongString();
+}
+
+TEST(testParse, simdScan) {
+    TestJson::TestSimdScan();
+}
+
 TEST(testStringify, literal) {
     TestJson::TestRoundTrip("null");
     TestJson::TestRoundTrip("false");
@@ -672,6 +3199,14 @@ TEST(testStringify, number) {
     TestJson::TestStringifyNumber();
 }
 
+TEST(testStringify, shortest) {
+    TestJson::TestStringifyShortest();
+}
+
+TEST(testStringify, reserve) {
+    TestJson::TestStringifyReserve();
+}
+
 TEST(testStringify, string) {
     TestJson::TestStringifyString();
 }
@@ -713,6 +3248,10 @@ TEST(testAccess, number) {
     TestJson::TestAccessNumber();
 }
 
+TEST(testAccess, integer) {
+    TestJson::TestAccessInteger();
+}
+
 TEST(testAccess, string) {
     TestJson::TestAccessString();
 }
@@ -725,6 +3264,189 @@ TEST(testAccess, object) {
     TestJson::TestAccessObject();
 }
 
+TEST(testAccess, move) {
+    TestJson::TestAccessMove();
+}
+
+TEST(testAccess, largeObject) {
+    TestJson::TestAccessLargeObject();
+}
+
+TEST(testAccess, view) {
+    TestJson::TestView();
+}
+
+TEST(testAccess, ref) {
+    TestJson::TestRef();
+}
+
+TEST(testDocument, access) {
+    TestJson::TestDocument();
+}
+
+TEST(testDocument, reuse) {
+    TestJson::TestDocumentReuse();
+}
+
+TEST(testDocument, inlineString) {
+    TestJson::TestDocumentInlineString();
+}
+
+TEST(testTape, access) {
+    TestJson::TestTape();
+}
+
+TEST(testTape, iterate) {
+    TestJson::TestTapeIterate();
+}
+
+TEST(testSax, events) {
+    TestJson::TestSax();
+}
+
+TEST(testPush, chunks) {
+    TestJson::TestPush();
+}
+
+TEST(testNdjson, lines) {
+    TestJson::TestNdjson();
+}
+
+TEST(testStructural, index) {
+    TestJson::TestStructural();
+}
+
+TEST(testParse, buffer) {
+    TestJson::TestParseBuffer();
+}
+
+TEST(testParse, result) {
+    TestJson::TestParseResult();
+}
+
+TEST(testParse, utf8) {
+    TestJson::TestUtf8();
+}
+
+TEST(testParse, validate) {
+    TestJson::TestValidate();
+}
+
+TEST(testLazy, access) {
+    TestJson::TestLazy();
+}
+
+TEST(testProjection, paths) {
+    TestJson::TestProjection();
+}
+
+TEST(testProjection, stopWhenFound) {
+    TestJson::TestStopWhenFound();
+}
+
+#else
+TEST(benchmark, parseDeepNesting) {
+    TestJson::BenchParseDeepNesting();
+}
+
+TEST(benchmark, buildArray) {
+    TestJson::BenchBuildArray();
+}
+
+TEST(benchmark, walkArray) {
+    TestJson::BenchWalkArray();
+}
+
+TEST(benchmark, buildObject) {
+    TestJson::BenchBuildObject();
+}
+
+TEST(benchmark, parseIndented) {
+    TestJson::BenchParseIndented();
+}
+
+TEST(benchmark, parseLongStrings) {
+    TestJson::BenchParseLongStrings();
+}
+
+TEST(benchmark, parseNumbers) {
+    TestJson::BenchParseNumbers();
+}
+
+TEST(benchmark, integers) {
+    TestJson::BenchIntegers();
+}
+
+TEST(benchmark, stringifyDoubles) {
+    TestJson::BenchStringifyDoubles();
+}
+
+TEST(benchmark, stringifyLongStrings) {
+    TestJson::BenchStringifyLongStrings();
+}
+
+TEST(benchmark, stringifyCorpus) {
+    TestJson::BenchStringifyCorpus();
+}
+
+
+TEST(benchmark, documentLoop) {
+    TestJson::BenchDocumentLoop();
+}
+
+TEST(benchmark, memoryPerNode) {
+    TestJson::BenchMemoryPerNode();
+}
+
+TEST(benchmark, traverse) {
+    TestJson::BenchTraverse();
+}
+
+TEST(benchmark, sax) {
+    TestJson::BenchSax();
+}
+
+TEST(benchmark, push) {
+    TestJson::BenchPush();
+}
+
+TEST(benchmark, ndjson) {
+    TestJson::BenchNdjson();
+}
+
+TEST(benchmark, indexed) {
+    TestJson::BenchIndexed();
+}
+
+TEST(benchmark, parseFile) {
+    TestJson::BenchParseFile();
+}
+
+TEST(benchmark, errors) {
+    TestJson::BenchErrors();
+}
+
+TEST(benchmark, validate) {
+    TestJson::BenchValidate();
+}
+
+TEST(benchmark, utf8Check) {
+    TestJson::BenchUtf8Check();
+}
+
+TEST(benchmark, lazy) {
+    TestJson::BenchLazy();
+}
+
+TEST(benchmark, projection) {
+    TestJson::BenchProjection();
+}
+
+TEST(benchmark, stopWhenFound) {
+    TestJson::BenchStopWhenFound();
+}
+#endif
+
 
 int main() {
     ::testing::InitGoogleTest();
@@ -0,0 +1,76 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_thread_pool.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现ThreadPool类
+**********************************************************************************/
+
+#include "json_thread_pool.h"
+
+namespace lwy {
+
+    namespace json {
+
+        ThreadPool::ThreadPool(size_t threads) : next_(0) {
+            for (size_t i = 1; i < threads; ++i)
+                workers_.emplace_back(&ThreadPool::work, this);
+        }
+
+        ThreadPool::~ThreadPool() noexcept {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            start_.notify_all();
+            for (std::thread &t : workers_)
+                t.join();
+        }
+
+        void ThreadPool::run(size_t count, const std::function<void(size_t)> &task) {
+            if (workers_.empty() || count <= 1) {
+                for (size_t i = 0; i < count; ++i)
+                    task(i);
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                task_ = &task;
+                count_ = count;
+                next_ = 0;
+                active_ = workers_.size();
+                ++generation_;
+            }
+            start_.notify_all();
+            drain();
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] { return active_ == 0; });
+            task_ = nullptr;
+        }
+
+        void ThreadPool::drain() noexcept {
+            for (size_t i; (i = next_.fetch_add(1)) < count_; )
+                (*task_)(i);
+        }
+
+        void ThreadPool::work() noexcept {
+            uint64_t seen = 0;
+            for (; ;) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                    if (stop_)
+                        return;
+                    seen = generation_;
+                }
+                drain();
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--active_ == 0)
+                    done_.notify_one();
+            }
+        }
+
+    }
+
+}
@@ -0,0 +1,61 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_thread_pool.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明ThreadPool线程池类, 工作线程常驻, 每次run把一批编号的任务分给各线程执行
+  *Function List:
+  * ThreadPool类主要成员函数功能:
+     1. ThreadPool(size_t threads);
+            共threads个线程参与执行, 其中调用run的线程算一个, 另外启动threads-1个工作线程
+     2. void run(size_t count, const std::function<void(size_t)> &task);
+            并行执行task(0) ... task(count-1), 全部完成后返回; 各线程用原子计数器领取下一个编号,
+            耗时不均的任务也能分摊均匀. task不能抛出异常; 同一时刻只能由一个线程调用run
+**********************************************************************************/
+
+#ifndef JSON_JSON_THREAD_POOL_H
+#define JSON_JSON_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lwy {
+
+    namespace json {
+
+        class ThreadPool final{
+        public:
+            explicit ThreadPool(size_t threads);
+            ~ThreadPool() noexcept;
+            ThreadPool(const ThreadPool &rhs) = delete;
+            ThreadPool& operator=(const ThreadPool &rhs) = delete;
+
+            void run(size_t count, const std::function<void(size_t)> &task);
+            size_t size() const noexcept { return workers_.size() + 1; }
+        private:
+            void work() noexcept;
+            void drain() noexcept;
+
+            std::vector<std::thread> workers_;
+            std::mutex mutex_;
+            std::condition_variable start_;
+            std::condition_variable done_;
+            const std::function<void(size_t)> *task_ = nullptr;
+            size_t count_ = 0;
+            std::atomic<size_t> next_;
+            size_t active_ = 0;         // 本批中尚未完成的工作线程数
+            uint64_t generation_ = 0;   // 每次run加一, 工作线程据此识别新的一批任务
+            bool stop_ = false;
+        };
+
+    }
+
+}
+
+#endif //JSON_JSON_THREAD_POOL_H
@@ -0,0 +1,287 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_utf8.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现UTF-8合法性校验, 有标量, SSSE3与AVX2三种实现, 运行时按CPU选择;
+  *              向量实现只判断一块是否合法, 出错时再由标量实现找出准确位置
+**********************************************************************************/
+
+#include "json_utf8.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LWY_JSON_RUNTIME_SIMD 1
+#endif
+
+namespace lwy {
+
+    namespace json {
+
+        // 码点范围	       字节1	    字节2	    字节3	    字节4
+        // U+0000 ~ U+007F	  0xxxxxxx
+        // U+0080 ~ U+07FF	  C2~DF     80~BF
+        // U+0800 ~ U+FFFF	  E0        A0~BF       80~BF
+        //                    E1~EC     80~BF       80~BF
+        //                    ED        80~9F       80~BF       (排除代理项)
+        //                    EE~EF     80~BF       80~BF
+        // U+10000 ~ U+10FFFF F0        90~BF       80~BF       80~BF
+        //                    F1~F3     80~BF       80~BF       80~BF
+        //                    F4        80~8F       80~BF       80~BF
+        static const char *find_invalid_utf8_scalar(const char *p, const char *end) noexcept {
+            while (p != end) {
+                // 8字节一组跳过ASCII
+                if (end - p >= 8) {
+                    uint64_t word;
+                    std::memcpy(&word, p, sizeof(word));
+                    if ((word & 0x8080808080808080ULL) == 0) {
+                        p += 8;
+                        continue;
+                    }
+                }
+                unsigned char c = static_cast<unsigned char>(*p);
+                if (c < 0x80) {
+                    ++p;
+                    continue;
+                }
+                int n;
+                unsigned char low = 0x80, high = 0xBF;
+                if (c >= 0xC2 && c <= 0xDF) {
+                    n = 1;
+                } else if (c >= 0xE0 && c <= 0xEF) {
+                    n = 2;
+                    if (c == 0xE0) low = 0xA0;
+                    else if (c == 0xED) high = 0x9F;
+                } else if (c >= 0xF0 && c <= 0xF4) {
+                    n = 3;
+                    if (c == 0xF0) low = 0x90;
+                    else if (c == 0xF4) high = 0x8F;
+                } else {
+                    return p;
+                }
+                if (end - p <= n)
+                    return p;
+                unsigned char c1 = static_cast<unsigned char>(p[1]);
+                if (c1 < low || c1 > high)
+                    return p;
+                for (int i = 2; i <= n; ++i) {
+                    if ((static_cast<unsigned char>(p[i]) & 0xC0) != 0x80)
+                        return p;
+                }
+                p += n + 1;
+            }
+            return p;
+        }
+
+        // 向量实现在从block开始的一块中发现了错误: 出错序列的首字节最多在block之前3字节处,
+        // 从那里之后的第一个非后续字节起逐字节定位
+        static const char *locate_invalid_utf8(const char *begin, const char *block, const char *end) noexcept {
+            const char *p = block - begin >= 3 ? block - 3 : begin;
+            while (p != block && (static_cast<unsigned char>(*p) & 0xC0) == 0x80)
+                ++p;
+            return find_invalid_utf8_scalar(p, end);
+        }
+
+#if LWY_JSON_RUNTIME_SIMD
+        // 查表法: 由前一字节的高4位, 低4位与当前字节的高4位各查一张表, 每一位代表一种错误,
+        // 三者相与后非0即为错误; 第3, 4字节处的"连续两个后续字节"由前2, 3字节是否为3, 4字节序列的首字节抵消
+        enum : uint8_t {
+            too_short = 1 << 0,         // 首字节或ASCII之后缺少后续字节
+            too_long = 1 << 1,          // ASCII之后出现后续字节
+            overlong_3 = 1 << 2,
+            too_large = 1 << 3,
+            surrogate = 1 << 4,
+            overlong_2 = 1 << 5,
+            too_large_1000 = 1 << 6,
+            overlong_4 = 1 << 6,
+            two_conts = 1 << 7,
+            carry = too_short | too_long | two_conts
+        };
+
+        alignas(16) static const uint8_t byte_1_high[16] = {
+            // 0xxx: ASCII
+            too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+            // 10xx: 后续字节
+            two_conts, two_conts, two_conts, two_conts,
+            // 1100, 1101: 2字节序列的首字节
+            too_short | overlong_2, too_short,
+            // 1110: 3字节序列的首字节
+            too_short | overlong_3 | surrogate,
+            // 1111: 4字节序列的首字节
+            too_short | too_large | too_large_1000 | overlong_4
+        };
+
+        alignas(16) static const uint8_t byte_1_low[16] = {
+            carry | overlong_3 | overlong_2 | overlong_4,
+            carry | overlong_2,
+            carry, carry,
+            carry | too_large,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000 | surrogate,
+            carry | too_large | too_large_1000,
+            carry | too_large | too_large_1000
+        };
+
+        alignas(16) static const uint8_t byte_2_high[16] = {
+            // 0xxx: ASCII
+            too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+            // 1000
+            too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+            // 1001
+            too_long | overlong_2 | two_conts | overlong_3 | too_large,
+            // 101x
+            too_long | overlong_2 | two_conts | surrogate | too_large,
+            too_long | overlong_2 | two_conts | surrogate | too_large,
+            // 11xx: 首字节
+            too_short, too_short, too_short, too_short
+        };
+
+        // 块的最后3个字节若是需要更多后续字节的首字节(分别不小于0xF0, 0xE0, 0xC0), 下一块必须接上
+        alignas(32) static const uint8_t incomplete_max[32] = {
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xEF, 0xDF, 0xBF
+        };
+
+        __attribute__((target("ssse3")))
+        static inline __m128i check_utf8_ssse3(__m128i input, __m128i prev_input, const __m128i *tables) noexcept {
+            const __m128i nibble = _mm_set1_epi8(0x0F);
+            __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+            __m128i special = _mm_and_si128(
+                    _mm_and_si128(_mm_shuffle_epi8(tables[0], _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                                  _mm_shuffle_epi8(tables[1], _mm_and_si128(prev1, nibble))),
+                    _mm_shuffle_epi8(tables[2], _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+            __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+            __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+            __m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80)),
+                                          _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80)));
+            return _mm_xor_si128(_mm_and_si128(must23, _mm_set1_epi8(static_cast<char>(0x80))), special);
+        }
+
+        __attribute__((target("ssse3")))
+        static const char *find_invalid_utf8_ssse3(const char *begin, const char *end) noexcept {
+            const __m128i tables[3] = {
+                _mm_load_si128(reinterpret_cast<const __m128i *>(byte_1_high)),
+                _mm_load_si128(reinterpret_cast<const __m128i *>(byte_1_low)),
+                _mm_load_si128(reinterpret_cast<const __m128i *>(byte_2_high))
+            };
+            const __m128i max = _mm_load_si128(reinterpret_cast<const __m128i *>(incomplete_max + 16));
+            const __m128i zero = _mm_setzero_si128();
+            __m128i prev = zero, incomplete = zero;
+            char tail[64];
+            for (const char *p = begin; ; p += 64) {
+                // 最后不足64字节的部分补0, 末尾未完成的序列因后面是ASCII而报错
+                const char *block = p;
+                bool last = end - p < 64;
+                if (last) {
+                    std::memset(tail, 0, sizeof(tail));
+                    if (p != end)
+                        std::memcpy(tail, p, end - p);
+                    block = tail;
+                }
+                __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+                __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16));
+                __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 32));
+                __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 48));
+                __m128i error;
+                if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3))) == 0) {
+                    error = incomplete;
+                    incomplete = zero;
+                } else {
+                    error = _mm_or_si128(_mm_or_si128(check_utf8_ssse3(v0, prev, tables), check_utf8_ssse3(v1, v0, tables)),
+                                         _mm_or_si128(check_utf8_ssse3(v2, v1, tables), check_utf8_ssse3(v3, v2, tables)));
+                    incomplete = _mm_subs_epu8(v3, max);
+                }
+                prev = v3;
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xFFFF)
+                    return locate_invalid_utf8(begin, p, end);
+                if (last)
+                    return end;
+            }
+        }
+
+        // 前一字节: 跨越128位通道时需要先拼出上一个向量的高半部分与当前向量的低半部分
+        __attribute__((target("avx2")))
+        static inline __m256i check_utf8_avx2(__m256i input, __m256i prev_input, const __m256i *tables) noexcept {
+            const __m256i nibble = _mm256_set1_epi8(0x0F);
+            __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+            __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+            __m256i special = _mm256_and_si256(
+                    _mm256_and_si256(_mm256_shuffle_epi8(tables[0], _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                                     _mm256_shuffle_epi8(tables[1], _mm256_and_si256(prev1, nibble))),
+                    _mm256_shuffle_epi8(tables[2], _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+            __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+            __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+            __m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80)),
+                                             _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80)));
+            return _mm256_xor_si256(_mm256_and_si256(must23, _mm256_set1_epi8(static_cast<char>(0x80))), special);
+        }
+
+        __attribute__((target("avx2")))
+        static const char *find_invalid_utf8_avx2(const char *begin, const char *end) noexcept {
+            const __m256i tables[3] = {
+                _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(byte_1_high))),
+                _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(byte_1_low))),
+                _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(byte_2_high)))
+            };
+            const __m256i max = _mm256_load_si256(reinterpret_cast<const __m256i *>(incomplete_max));
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i prev = zero, incomplete = zero;
+            char tail[64];
+            for (const char *p = begin; ; p += 64) {
+                const char *block = p;
+                bool last = end - p < 64;
+                if (last) {
+                    std::memset(tail, 0, sizeof(tail));
+                    if (p != end)
+                        std::memcpy(tail, p, end - p);
+                    block = tail;
+                }
+                __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+                __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+                __m256i error;
+                if (_mm256_movemask_epi8(_mm256_or_si256(v0, v1)) == 0) {
+                    error = incomplete;
+                    incomplete = zero;
+                } else {
+                    error = _mm256_or_si256(check_utf8_avx2(v0, prev, tables), check_utf8_avx2(v1, v0, tables));
+                    incomplete = _mm256_subs_epu8(v1, max);
+                }
+                prev = v1;
+                if (!_mm256_testz_si256(error, error))
+                    return locate_invalid_utf8(begin, p, end);
+                if (last)
+                    return end;
+            }
+        }
+#endif
+
+        const char *find_invalid_utf8(const char *p, const char *end, int level) noexcept {
+#if LWY_JSON_RUNTIME_SIMD
+            if (level >= simd_avx2)
+                return find_invalid_utf8_avx2(p, end);
+            if (level >= simd_ssse3)
+                return find_invalid_utf8_ssse3(p, end);
+#else
+            (void)level;
+#endif
+            return find_invalid_utf8_scalar(p, end);
+        }
+
+        const char *find_invalid_utf8(const char *p, const char *end) noexcept {
+            return find_invalid_utf8(p, end, detect_simd_level());
+        }
+
+    }
+
+}
@@ -0,0 +1,35 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_utf8.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明UTF-8合法性校验: 按64字节一块用查表法(按前一字节的高低4位与当前字节的高4位
+  *              查三张16项的表, 三者相与即为错误)并行检查每个字节, 纯ASCII的块只需一次比较;
+  *              有SSSE3与AVX2两种向量实现, 运行时按CPU选择, 其他平台退化为逐字节的标量实现
+  *Function List:
+     1. const char *find_invalid_utf8(const char *p, const char *end, int level) noexcept;
+        const char *find_invalid_utf8(const char *p, const char *end) noexcept;
+            返回[p, end)中第一个不合法序列的起始字节, 全部合法时返回end; 不合法包括非法的首字节,
+            缺少或多余的后续字节, 过长编码, 代理项(U+D800~U+DFFF)以及超过U+10FFFF的码点;
+            level为json_simd.h中的simd_level, 省略时使用detect_simd_level()的结果
+            解析器在扫描字符串时已顺带知道一段原文是否全为ASCII(见json_simd.h), 只对含非ASCII字节的段调用
+**********************************************************************************/
+
+#ifndef JSON_JSON_UTF8_H
+#define JSON_JSON_UTF8_H
+
+#include "json_simd.h"
+
+namespace lwy {
+
+    namespace json {
+
+        const char *find_invalid_utf8(const char *p, const char *end, int level) noexcept;
+        const char *find_invalid_utf8(const char *p, const char *end) noexcept;
+
+    }
+
+}
+
+#endif //JSON_JSON_UTF8_H
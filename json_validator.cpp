@@ -0,0 +1,30 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_validator.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现只做校验的解析
+**********************************************************************************/
+
+#include "json_validator.h"
+
+#include "json_reader.h"
+
+namespace lwy {
+
+    namespace json {
+
+        // 字符串原文的UTF-8由Reader在扫描字符串时校验, 错误的种类与位置和Parser相同
+        error_code validate_document(const char *begin, const char *end, size_t &offset) {
+            Validator validator;
+            Reader<Validator, false> reader(validator, begin, end);
+            error_code code = reader.parse();
+            if (code != json::Ok)
+                offset = reader.get_error_offset();
+            return code;
+        }
+
+    }
+
+}
@@ -0,0 +1,51 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_validator.h
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件声明只做校验的Validator类: 作为Reader<Validator, false>的处理器, 忽略所有事件,
+  *              语法与Json::parse完全相同, 但不构造结果, 不解码字符串
+  *Function List:
+  * Validator类主要成员函数功能:
+     1. void on_xxx(...);
+            所有事件均为空函数, 内联后Reader只剩下语法检查
+  * 其他函数:
+     1. error_code validate_document(const char *begin, const char *end, size_t &offset);
+            检查[begin, end)的语法与字符串原文的UTF-8, 返回错误码, 出错的字节偏移存入offset;
+            字符串外的非ASCII字节本身就是语法错误, 因此整个内容都是合法的UTF-8
+**********************************************************************************/
+
+#ifndef JSON_JSON_VALIDATOR_H
+#define JSON_JSON_VALIDATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include "json.h"
+
+namespace lwy {
+
+    namespace json {
+
+        class Validator final{
+        public:
+            void on_null() noexcept { }
+            void on_bool(bool) noexcept { }
+            void on_double(double) noexcept { }
+            void on_int64(int64_t) noexcept { }
+            void on_uint64(uint64_t) noexcept { }
+            void on_string(const char *, size_t, bool) noexcept { }
+            void on_start_array() noexcept { }
+            void on_end_array(size_t) noexcept { }
+            void on_start_object() noexcept { }
+            void on_key(const char *, size_t, bool) noexcept { }
+            void on_end_object(size_t) noexcept { }
+        };
+
+        error_code validate_document(const char *begin, const char *end, size_t &offset);
+
+    }
+
+}
+
+#endif //JSON_JSON_VALIDATOR_H
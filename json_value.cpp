@@ -8,21 +8,116 @@
 **********************************************************************************/
 
 #include <cassert>
+#include <functional>
 #include <string>
 #include "json_value.h"
 #include "json_parser.h"
 #include "json_generator.h"
+#include "json_number.h"
 
 namespace lwy {
 
     namespace json {
 
+        ObjectIndex::ObjectIndex(const std::vector<std::pair<std::string, Value>> &members) noexcept {
+            rehash(16);
+            for (size_t i = 0; i < members.size(); ++i) {
+                if (find(members, members[i].first) == static_cast<size_t>(-1))
+                    insert(members, i);
+            }
+        }
+
+        size_t ObjectIndex::find(const std::vector<std::pair<std::string, Value>> &members,
+                                 const std::string &key) const noexcept {
+            size_t hash = std::hash<std::string>()(key);
+            size_t mask = slots_.size() - 1;
+            for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+                const Slot &slot = slots_[i];
+                if (slot.index == 0)
+                    return -1;
+                if (slot.hash == hash && members[slot.index - 1].first == key)
+                    return slot.index - 1;
+            }
+        }
+
+        void ObjectIndex::insert(const std::vector<std::pair<std::string, Value>> &members, size_t index) noexcept {
+            // 装载因子不超过1/2, 保证线性探测的链足够短
+            if ((size_ + 1) * 2 > slots_.size())
+                rehash(slots_.size() * 2);
+            place(std::hash<std::string>()(members[index].first), index);
+        }
+
+        void ObjectIndex::erase(const std::vector<std::pair<std::string, Value>> &members, size_t index) noexcept {
+            const std::string &key = members[index].first;
+            size_t hash = std::hash<std::string>()(key);
+            size_t mask = slots_.size() - 1;
+            size_t i = hash & mask;
+            while (slots_[i].index != 0 && slots_[i].index != index + 1)
+                i = (i + 1) & mask;
+            // 重复的键只索引第一个, 找不到槽时被删的是未登记的重复键
+            if (slots_[i].index != 0) {
+                slots_[i].index = 0;
+                --size_;
+                // 向后移位删除: 探测链上其后的槽若初始位置不在(i, j]之间, 则移入空出的槽, 保证查找不断链
+                for (size_t j = (i + 1) & mask; slots_[j].index != 0; j = (j + 1) & mask) {
+                    if (((j - (slots_[j].hash & mask)) & mask) >= ((j - i) & mask)) {
+                        slots_[i] = slots_[j];
+                        slots_[j].index = 0;
+                        i = j;
+                    }
+                }
+                for (size_t k = index + 1; k < members.size(); ++k) {
+                    if (members[k].first == key) {
+                        place(hash, k);
+                        break;
+                    }
+                }
+            }
+            for (Slot &slot : slots_) {
+                if (slot.index > index + 1)
+                    --slot.index;
+            }
+        }
+
+        void ObjectIndex::place(size_t hash, size_t index) noexcept {
+            size_t mask = slots_.size() - 1;
+            size_t i = hash & mask;
+            while (slots_[i].index != 0)
+                i = (i + 1) & mask;
+            slots_[i].hash = hash;
+            slots_[i].index = index + 1;
+            ++size_;
+        }
+
+        // capacity须为2的幂
+        void ObjectIndex::rehash(size_t capacity) noexcept {
+            std::vector<Slot> old(capacity, Slot{0, 0});
+            old.swap(slots_);
+            size_t mask = capacity - 1;
+            for (const Slot &slot : old) {
+                if (slot.index == 0)
+                    continue;
+                size_t i = slot.hash & mask;
+                while (slots_[i].index != 0)
+                    i = (i + 1) & mask;
+                slots_[i] = slot;
+            }
+        }
+
         Value& Value::operator=(const Value &rhs) noexcept {
             free();
             init(rhs);
             return *this;
         }
 
+        Value& Value::operator=(Value &&rhs) noexcept {
+            if (this != &rhs) {
+                free();
+                init(std::move(rhs));
+            }
+            return *this;
+        }
+
         Value::~Value() noexcept {
             free();
         }
@@ -31,21 +126,47 @@ namespace lwy {
             type_ = rhs.type_;
             switch (type_) {
                 case json::Number:
-                    num_ = rhs.num_;
+                    num_type_ = rhs.num_type_;
+                    u64_ = rhs.u64_;
                     break;
                 case json::String:
                     new(&str_) std::string(rhs.str_);
+                    escape_free_ = rhs.escape_free_;
                     break;
                 case json::Array:
                     new(&arr_) std::vector<Value>(rhs.arr_);
                     break;
                 case json::Object:
-                    new(&obj_) std::vector<std::pair<std::string, Value>>(rhs.obj_);
+                    // 索引只保存下标, 可以直接拷贝给副本
+                    new(&obj_) Object{rhs.obj_.members, std::unique_ptr<ObjectIndex>(
+                            rhs.obj_.index ? new ObjectIndex(*rhs.obj_.index) : nullptr)};
                     break;
                 default:
                     break;
             }
         }
+        void Value::init(Value &&rhs) noexcept {
+            type_ = rhs.type_;
+            switch (type_) {
+                case json::Number:
+                    num_type_ = rhs.num_type_;
+                    u64_ = rhs.u64_;
+                    break;
+                case json::String:
+                    new(&str_) std::string(std::move(rhs.str_));
+                    escape_free_ = rhs.escape_free_;
+                    break;
+                case json::Array:
+                    new(&arr_) std::vector<Value>(std::move(rhs.arr_));
+                    break;
+                case json::Object:
+                    new(&obj_) Object(std::move(rhs.obj_));
+                    break;
+                default:
+                    break;
+            }
+            rhs.set_type(json::Null);
+        }
         void Value::free() noexcept {
             using std::string;
             switch (type_) {
@@ -56,13 +177,19 @@ namespace lwy {
                     arr_.~vector<Value>();
                     break;
                 case json::Object:
-                    obj_.~vector<std::pair<std::string, Value>>();
+                    obj_.~Object();
                     break;
                 default:
                     break;
             }
         }
 
+        void Value::index_object() noexcept {
+            assert(type_ == json::Object);
+            if (!obj_.index && obj_.members.size() >= object_index_threshold)
+                obj_.index.reset(new ObjectIndex(obj_.members));
+        }
+
         int Value::get_type() const noexcept {
             return type_;
         }
@@ -73,19 +200,58 @@ namespace lwy {
 
         double Value::get_number() const noexcept {
             assert(type_ == json::Number);
-            return num_;
+            switch (num_type_) {
+                case json::Int64: return static_cast<double>(i64_);
+                case json::Uint64: return static_cast<double>(u64_);
+                default: return num_;
+            }
         }
         void Value::set_number(double d) noexcept {
             free();
             type_ = json::Number;
+            num_type_ = json::Double;
             num_ = d;
         }
+        int Value::get_number_type() const noexcept {
+            assert(type_ == json::Number);
+            return static_cast<json::number_type>(num_type_);
+        }
+        // 整数之间按C++的类型转换规则转换; double的小数部分被截断, 超出范围时取边界值, NaN为0
+        int64_t Value::get_int64() const noexcept {
+            assert(type_ == json::Number);
+            switch (num_type_) {
+                case json::Int64: return i64_;
+                case json::Uint64: return static_cast<int64_t>(u64_);
+                default: return double_to_int64(num_);
+            }
+        }
+        void Value::set_int64(int64_t i) noexcept {
+            free();
+            type_ = json::Number;
+            num_type_ = json::Int64;
+            i64_ = i;
+        }
+        uint64_t Value::get_uint64() const noexcept {
+            assert(type_ == json::Number);
+            switch (num_type_) {
+                case json::Int64: return static_cast<uint64_t>(i64_);
+                case json::Uint64: return u64_;
+                default: return double_to_uint64(num_);
+            }
+        }
+        void Value::set_uint64(uint64_t u) noexcept {
+            free();
+            type_ = json::Number;
+            num_type_ = json::Uint64;
+            u64_ = u;
+        }
 
         const std::string& Value::get_string() const noexcept {
             assert(type_ == json::String);
             return str_;
         }
         void Value::set_string(const std::string& str) noexcept {
+            escape_free_ = false;
             if (type_ == json::String)
                 str_ = str;
             else {
@@ -94,6 +260,21 @@ namespace lwy {
                 new(&str_) std::string(str);
             }
         }
+        void Value::set_string(std::string &&str) noexcept {
+            escape_free_ = false;
+            if (type_ == json::String)
+                str_ = std::move(str);
+            else {
+                free();
+                type_ = json::String;
+                new(&str_) std::string(std::move(str));
+            }
+        }
+
+        bool Value::is_escape_free() const noexcept {
+            assert(type_ == json::String);
+            return escape_free_;
+        }
 
         size_t Value::get_array_size() const noexcept {
             assert(type_ == json::Array);
@@ -103,6 +284,10 @@ namespace lwy {
             assert(type_ == json::Array);
             return arr_[index];
         }
+        Value& Value::get_array_element(size_t index) noexcept {
+            assert(type_ == json::Array);
+            return arr_[index];
+        }
         void Value::set_array(const std::vector<Value> &arr) noexcept {
             if (type_ == json::Array)
                 arr_ = arr;
@@ -112,10 +297,23 @@ namespace lwy {
                 new(&arr_) std::vector<Value>(arr);
             }
         }
+        void Value::set_array(std::vector<Value> &&arr) noexcept {
+            if (type_ == json::Array)
+                arr_ = std::move(arr);
+            else {
+                free();
+                type_ = json::Array;
+                new(&arr_) std::vector<Value>(std::move(arr));
+            }
+        }
         void Value::pushback_array_element(const Value& val) noexcept {
             assert(type_ == json::Array);
             arr_.push_back(val);
         }
+        void Value::pushback_array_element(Value &&val) noexcept {
+            assert(type_ == json::Array);
+            arr_.push_back(std::move(val));
+        }
         void Value::popback_array_element() noexcept {
             assert(type_ == json::Array);
             arr_.pop_back();
@@ -124,6 +322,10 @@ namespace lwy {
             assert(type_ == json::Array);
             arr_.insert(arr_.begin() + index, val);
         }
+        void Value::insert_array_element(Value &&val, size_t index) noexcept {
+            assert(type_ == json::Array);
+            arr_.insert(arr_.begin() + index, std::move(val));
+        }
         void Value::erase_array_element(size_t index, size_t count) noexcept {
             assert(type_ == json::Array);
             arr_.erase(arr_.begin() + index, arr_.begin() + index + count);
@@ -135,58 +337,100 @@ namespace lwy {
 
         size_t Value::get_object_size() const noexcept {
             assert(type_ == json::Object);
-            return obj_.size();
+            return obj_.members.size();
         }
         const std::string& Value::get_object_key(size_t index) const noexcept {
             assert(type_ == json::Object);
-            return obj_[index].first;
+            return obj_.members[index].first;
         }
         size_t Value::get_object_key_length(size_t index) const noexcept {
             assert(type_ == json::Object);
-            return obj_[index].first.size();
+            return obj_.members[index].first.size();
         }
         const Value& Value::get_object_value(size_t index) const noexcept {
             assert(type_ == json::Object);
-            return obj_[index].second;
+            return obj_.members[index].second;
+        }
+        Value& Value::get_object_value(size_t index) noexcept {
+            assert(type_ == json::Object);
+            return obj_.members[index].second;
         }
         void Value::set_object_value(const std::string &key, const Value &val) noexcept {
             assert(type_ == json::Object);
             auto index = find_object_index(key);
-            if (index >= 0) {
-                obj_[index].second = val;
+            if (index != static_cast<size_t>(-1)) {
+                obj_.members[index].second = val;
             }
             else {
-                obj_.emplace_back(key, val);
+                obj_.members.emplace_back(key, val);
+                if (obj_.index)
+                    obj_.index->insert(obj_.members, obj_.members.size() - 1);
+                else
+                    index_object();
+            }
+        }
+        void Value::set_object_value(std::string &&key, Value &&val) noexcept {
+            assert(type_ == json::Object);
+            auto index = find_object_index(key);
+            if (index != static_cast<size_t>(-1)) {
+                obj_.members[index].second = std::move(val);
+            }
+            else {
+                obj_.members.emplace_back(std::move(key), std::move(val));
+                if (obj_.index)
+                    obj_.index->insert(obj_.members, obj_.members.size() - 1);
+                else
+                    index_object();
             }
         }
         void Value::set_object(const std::vector<std::pair<std::string, Value>> &obj) noexcept {
-            if(type_ == json::Object)
-                obj_ = obj;
+            if(type_ == json::Object) {
+                obj_.members = obj;
+                obj_.index.reset();
+            }
+            else{
+                free();
+                type_ = json::Object;
+                new(&obj_) Object{obj, nullptr};
+            }
+            index_object();
+        }
+        void Value::set_object(std::vector<std::pair<std::string, Value>> &&obj) noexcept {
+            if(type_ == json::Object) {
+                obj_.members = std::move(obj);
+                obj_.index.reset();
+            }
             else{
                 free();
                 type_ = json::Object;
-                new(&obj_) std::vector<std::pair<std::string, Value>>(obj);
+                new(&obj_) Object{std::move(obj), nullptr};
             }
+            index_object();
         }
         size_t Value::find_object_index(const std::string &key) const noexcept {
             assert(type_ == json::Object);
-            for(size_t i = 0; i < obj_.size(); ++i) {
-                if(obj_[i].first == key)
+            if (obj_.index)
+                return obj_.index->find(obj_.members, key);
+            for(size_t i = 0; i < obj_.members.size(); ++i) {
+                if(obj_.members[i].first == key)
                     return i;
             }
             return -1;
         }
         void Value::remove_object_value(size_t index) noexcept {
             assert(type_ == json::Object);
-            obj_.erase(obj_.begin() + index, obj_.begin() + index + 1);
+            if (obj_.index)
+                obj_.index->erase(obj_.members, index);
+            obj_.members.erase(obj_.members.begin() + index, obj_.members.begin() + index + 1);
         }
         void Value::clear_object() noexcept {
             assert(type_ == json::Object);
-            obj_.clear();
+            obj_.members.clear();
+            obj_.index.reset();
         }
 
-        void Value::parse(const std::string &content) {
-            Parser(*this, content);
+        error_code Value::parse(const char *begin, const char *end, parse_mode mode, size_t &offset) {
+            return Parser(*this).parse(begin, end, mode, offset);
         }
 
         void Value::stringify(std::string &content) const noexcept {
@@ -200,7 +444,14 @@ namespace lwy {
                 case json::String:
                     return lhs.str_ == rhs.str_;
                 case json::Number:
-                    return lhs.num_ == rhs.num_;
+                    // 两个整数精确比较, 含double时按double比较
+                    if (lhs.num_type_ == json::Double || rhs.num_type_ == json::Double)
+                        return lhs.get_number() == rhs.get_number();
+                    if (lhs.num_type_ == rhs.num_type_)
+                        return lhs.u64_ == rhs.u64_;
+                    if (lhs.num_type_ == json::Int64)
+                        return lhs.i64_ >= 0 && static_cast<uint64_t>(lhs.i64_) == rhs.u64_;
+                    return rhs.i64_ >= 0 && static_cast<uint64_t>(rhs.i64_) == lhs.u64_;
                 case json::Array:
                     return lhs.arr_ == rhs.arr_;
                 case json::Object:
@@ -208,7 +459,7 @@ namespace lwy {
                         return false;
                     for (size_t i = 0; i < lhs.get_object_size(); ++i) {
                         auto index = rhs.find_object_index(lhs.get_object_key(i));
-                        if(index < 0 || lhs.get_object_value(i) != rhs.get_object_value(index))
+                        if(index == static_cast<size_t>(-1) || lhs.get_object_value(i) != rhs.get_object_value(index))
                             return false;
                     }
                     return true;
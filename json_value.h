@@ -7,8 +7,8 @@
   *Description:  此文件声明存储表示JSON各种值的Value类, 采用union来存储Json结点，节省内存空间
   *Function List:
   * Value类主要成员函数功能:
-     1. void parse(const std::string &content);
-            解析content字符串,结果放入本类的数据成员union中
+     1. error_code parse(const char *begin, const char *end, parse_mode mode, size_t &offset);
+            解析[begin, end)中的内容,结果放入本类的数据成员union中; 返回错误码, 出错处的偏移放入offset
      2. void stringify(std::string &content) const noexcept;
             将本类的数据成员序列化为字符串
      4. void set_xxx() noexcept;
@@ -18,9 +18,13 @@
      6. void xxx_array_element(...) ...;
             对数组结点类型做相关操作: 入队,出队,插入,删除
      7. xxx_object_xxx(...) ...;
-            对Json对象类型做相关操作,键值对存储结构采用pair动态数组实现
+            对Json对象类型做相关操作,键值对存储结构采用pair动态数组实现;
+            成员数达到阈值时由修改对象的函数(及解析器在对象结束时)建立哈希索引(ObjectIndex),
+            增删成员时同步维护; 查找只读, 多个线程可以同时查找同一对象
      8. void init(const Value &rhs) noexcept;
             为数据成员申请内存
+        void init(Value &&rhs) noexcept;
+            移动rhs的数据成员, 不申请内存; 各set_xxx/xxx_element的右值版本同样只移动不拷贝
      9. void free() noexcept;
             释放数据成员的内存
 **********************************************************************************/
@@ -28,6 +32,7 @@
 #ifndef JSON_JSON_VALUE_H
 #define JSON_JSON_VALUE_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <utility>
@@ -37,9 +42,34 @@ namespace lwy {
 
     namespace json {
 
+        class Value;
+
+        // 对象键的开放寻址哈希索引, 槽中只保存成员下标, 键仍存放在对象的pair数组中以保持插入顺序
+        // 重复的键只索引第一个, 与线性查找的结果一致
+        class ObjectIndex final{
+        public:
+            explicit ObjectIndex(const std::vector<std::pair<std::string, Value>> &members) noexcept;
+            size_t find(const std::vector<std::pair<std::string, Value>> &members,
+                        const std::string &key) const noexcept;
+            // 登记新追加的第index个成员, 调用者保证其键尚未出现
+            void insert(const std::vector<std::pair<std::string, Value>> &members, size_t index) noexcept;
+            // 在删除第index个成员之前调用: 去掉它的槽, 其后成员的下标减1; 同键的后一个成员补入索引
+            void erase(const std::vector<std::pair<std::string, Value>> &members, size_t index) noexcept;
+        private:
+            struct Slot {
+                size_t hash;
+                size_t index;   // 成员下标+1, 0表示空槽
+            };
+            void place(size_t hash, size_t index) noexcept;
+            void rehash(size_t capacity) noexcept;
+
+            std::vector<Slot> slots_;
+            size_t size_ = 0;
+        };
+
         class Value final{
         public:
-            void parse(const std::string &content);
+            error_code parse(const char *begin, const char *end, parse_mode mode, size_t &offset);
             void stringify(std::string &content) const noexcept;
 
             int get_type() const noexcept;
@@ -47,16 +77,28 @@ namespace lwy {
 
             double get_number() const noexcept;
             void set_number(double d) noexcept;
+            int get_number_type() const noexcept;
+            int64_t get_int64() const noexcept;
+            void set_int64(int64_t i) noexcept;
+            uint64_t get_uint64() const noexcept;
+            void set_uint64(uint64_t u) noexcept;
 
             const std::string& get_string() const noexcept;
             void set_string(const std::string &str) noexcept;
+            void set_string(std::string &&str) noexcept;
+            // 为true时字符串中一定没有需要转义的字符, 生成器可以整段拷贝; false表示未知
+            bool is_escape_free() const noexcept;
 
             size_t get_array_size() const noexcept;
             const Value& get_array_element(size_t index) const noexcept;
+            Value& get_array_element(size_t index) noexcept;
             void set_array(const std::vector<Value> &arr) noexcept;
+            void set_array(std::vector<Value> &&arr) noexcept;
             void pushback_array_element(const Value& val) noexcept;
+            void pushback_array_element(Value &&val) noexcept;
             void popback_array_element() noexcept;
             void insert_array_element(const Value &val, size_t index) noexcept;
+            void insert_array_element(Value &&val, size_t index) noexcept;
             void erase_array_element(size_t index, size_t count) noexcept;
             void clear_array() noexcept;
 
@@ -64,31 +106,60 @@ namespace lwy {
             const std::string& get_object_key(size_t index) const noexcept;
             size_t get_object_key_length(size_t index) const noexcept;
             const Value& get_object_value(size_t index) const noexcept;
+            Value& get_object_value(size_t index) noexcept;
             void set_object_value(const std::string &key, const Value &val) noexcept;
+            void set_object_value(std::string &&key, Value &&val) noexcept;
             void set_object(const std::vector<std::pair<std::string, Value>> &obj) noexcept;
+            void set_object(std::vector<std::pair<std::string, Value>> &&obj) noexcept;
             size_t find_object_index(const std::string &key) const noexcept;
             void remove_object_value(size_t index) noexcept;
             void clear_object() noexcept;
 
             Value() noexcept : num_(0) {}
             Value(const Value &rhs) noexcept : num_(0) { init(rhs); }
+            Value(Value &&rhs) noexcept : num_(0) { init(std::move(rhs)); }
             Value& operator=(const Value &rhs) noexcept;
+            Value& operator=(Value &&rhs) noexcept;
             ~Value() noexcept;
 
         private:
+            // 成员数达到该值后才建立哈希索引, 小对象线性查找更快
+            static const size_t object_index_threshold = 16;
+
+            // 对象结点: 成员按插入顺序存放, 大对象附带索引
+            struct Object {
+                std::vector<std::pair<std::string, Value>> members;
+                std::unique_ptr<ObjectIndex> index;
+            };
+
             void init(const Value &rhs) noexcept;
+            // 接管rhs的资源, rhs被置为Null
+            void init(Value &&rhs) noexcept;
             // 手动析构结点的union中非基本类型的成员
             void free() noexcept;
+            // 成员数达到阈值且还没有索引时建立索引; 直接向members追加成员的解析器在对象结束时调用
+            void index_object() noexcept;
 
             json::type type_ = json::Null;
+            // 以下两个成员与type_共用union前的8字节, 不增加结点大小
+            uint8_t num_type_ = json::Double;    // json::number_type, 仅对Number结点有意义
+            bool escape_free_ = false;           // 仅对String结点有意义, 由解析器设置
             union {
                 double num_;
+                int64_t i64_;
+                uint64_t u64_;
                 std::string str_;
                 std::vector<Value> arr_;
-                std::vector<std::pair<std::string, Value>> obj_;
+                Object obj_;
             };
 
             friend bool operator==(const Value &lhs, const Value &rhs) noexcept;
+            // 解析器直接在父结点的数组/对象中就地构造子结点, 避免逐层拷贝
+            friend class Parser;
+            // 投影解析只构造选中的成员, 同样就地构造
+            friend class Projector;
+            // 生成器预先计算输出长度时直接读取结点, 这一遍遍历应当尽可能便宜
+            friend class Generator;
         };
         bool operator==(const Value &lhs, const Value &rhs) noexcept;
         bool operator!=(const Value &lhs, const Value &rhs) noexcept;
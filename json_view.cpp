@@ -0,0 +1,238 @@
+/*********************************************************************************
+  *Copyright(C),Lwy
+  *FileName:  json_view.cpp
+  *Author:  lwy
+  *Version:  1.3
+  *Date:  2022-03-23
+  *Description:  此文件实现JsonView与JsonRef类, 二者只保存指向解析树结点的指针,
+  *              访问子结点时直接返回新的句柄, 不分配内存也不拷贝子树
+**********************************************************************************/
+
+#include "json.h"
+
+#include <utility>
+#include "json_value.h"
+
+namespace lwy {
+
+    JsonView::JsonView(const Json &rhs) noexcept : v(rhs.v.get()) { }
+
+    void JsonView::stringify(std::string &content) const noexcept {
+        v-> stringify(content);
+    }
+
+    int JsonView::get_type() const noexcept {
+        return v-> get_type();
+    }
+
+    double JsonView::get_number() const noexcept {
+        return v-> get_number();
+    }
+
+    int JsonView::get_number_type() const noexcept {
+        return v-> get_number_type();
+    }
+
+    int64_t JsonView::get_int64() const noexcept {
+        return v-> get_int64();
+    }
+
+    uint64_t JsonView::get_uint64() const noexcept {
+        return v-> get_uint64();
+    }
+
+    const std::string& JsonView::get_string() const noexcept {
+        return v-> get_string();
+    }
+
+    size_t JsonView::get_array_size() const noexcept {
+        return v-> get_array_size();
+    }
+
+    JsonView JsonView::get_array_element(size_t index) const noexcept {
+        return JsonView(&v-> get_array_element(index));
+    }
+
+    size_t JsonView::get_object_size() const noexcept {
+        return v-> get_object_size();
+    }
+
+    const std::string& JsonView::get_object_key(size_t index) const noexcept {
+        return v-> get_object_key(index);
+    }
+
+    size_t JsonView::get_object_key_length(size_t index) const noexcept {
+        return v-> get_object_key_length(index);
+    }
+
+    JsonView JsonView::get_object_value(size_t index) const noexcept {
+        return JsonView(&v-> get_object_value(index));
+    }
+
+    long long JsonView::find_object_index(const std::string &key) const noexcept {
+        return v-> find_object_index(key);
+    }
+
+    bool operator==(const JsonView &lhs, const JsonView &rhs) noexcept {
+        return *lhs.v == *rhs.v;
+    }
+
+    bool operator!=(const JsonView &lhs, const JsonView &rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+
+    JsonRef::JsonRef(Json &rhs) noexcept : root(rhs.v.get()), v(rhs.v.get()) { }
+
+    void JsonRef::stringify(std::string &content) const noexcept {
+        v-> stringify(content);
+    }
+
+    int JsonRef::get_type() const noexcept {
+        return v-> get_type();
+    }
+
+    void JsonRef::set_null() noexcept {
+        v-> set_type(json::Null);
+    }
+
+    void JsonRef::set_boolean(bool b) noexcept {
+        if(b) v->set_type(json::True);
+        else v->set_type(json::False);
+    }
+
+    double JsonRef::get_number() const noexcept {
+        return v-> get_number();
+    }
+
+    void JsonRef::set_number(double d) noexcept {
+        v-> set_number(d);
+    }
+
+    int JsonRef::get_number_type() const noexcept {
+        return v-> get_number_type();
+    }
+
+    int64_t JsonRef::get_int64() const noexcept {
+        return v-> get_int64();
+    }
+
+    void JsonRef::set_int64(int64_t i) noexcept {
+        v-> set_int64(i);
+    }
+
+    uint64_t JsonRef::get_uint64() const noexcept {
+        return v-> get_uint64();
+    }
+
+    void JsonRef::set_uint64(uint64_t u) noexcept {
+        v-> set_uint64(u);
+    }
+
+    const std::string& JsonRef::get_string() const noexcept {
+        return v-> get_string();
+    }
+
+    void JsonRef::set_string(const std::string &str) noexcept {
+        v-> set_string(str);
+    }
+
+    void JsonRef::set_string(std::string &&str) noexcept {
+        v-> set_string(std::move(str));
+    }
+
+    void JsonRef::set_value(const Json &val) noexcept {
+        // val可能就是所指结点或其祖先, 先拷出再移入, 避免释放后再读
+        json::Value tmp(*val.v);
+        *v = std::move(tmp);
+    }
+
+    void JsonRef::set_value(Json &&val) noexcept {
+        // Json总是持有整棵树, 能包含所指结点的只有所在树的根;
+        // 从根移入自己的子结点不可能成立, 按拷贝处理
+        if (val.v.get() == root)
+            set_value(static_cast<const Json&>(val));
+        else
+            *v = std::move(*val.v);
+    }
+
+    size_t JsonRef::get_array_size() const noexcept {
+        return v-> get_array_size();
+    }
+
+    JsonRef JsonRef::get_array_element(size_t index) const noexcept {
+        return JsonRef(root, &v-> get_array_element(index));
+    }
+
+    void JsonRef::set_array() noexcept {
+        v-> set_array(std::vector<json::Value>{});
+    }
+
+    void JsonRef::pushback_array_element(const Json &val) noexcept {
+        v-> pushback_array_element(*val.v);
+    }
+
+    void JsonRef::pushback_array_element(Json &&val) noexcept {
+        v-> pushback_array_element(std::move(*val.v));
+    }
+
+    void JsonRef::popback_array_element() noexcept {
+        v-> popback_array_element();
+    }
+
+    void JsonRef::insert_array_element(const Json &val, size_t index) noexcept {
+        v-> insert_array_element(*val.v, index);
+    }
+
+    void JsonRef::insert_array_element(Json &&val, size_t index) noexcept {
+        v-> insert_array_element(std::move(*val.v), index);
+    }
+
+    void JsonRef::erase_array_element(size_t index, size_t count) noexcept {
+        v-> erase_array_element(index, count);
+    }
+
+    void JsonRef::clear_array() noexcept {
+        v-> clear_array();
+    }
+
+    void JsonRef::set_object() noexcept {
+        v-> set_object(std::vector<std::pair<std::string, json::Value>>{});
+    }
+
+    size_t JsonRef::get_object_size() const noexcept {
+        return v-> get_object_size();
+    }
+
+    const std::string& JsonRef::get_object_key(size_t index) const noexcept {
+        return v-> get_object_key(index);
+    }
+
+    size_t JsonRef::get_object_key_length(size_t index) const noexcept {
+        return v-> get_object_key_length(index);
+    }
+
+    JsonRef JsonRef::get_object_value(size_t index) const noexcept {
+        return JsonRef(root, &v-> get_object_value(index));
+    }
+
+    void JsonRef::set_object_value(const std::string &key, const Json &val) noexcept {
+        v-> set_object_value(key, *val.v);
+    }
+
+    void JsonRef::set_object_value(std::string &&key, Json &&val) noexcept {
+        v-> set_object_value(std::move(key), std::move(*val.v));
+    }
+
+    long long JsonRef::find_object_index(const std::string &key) const noexcept {
+        return v-> find_object_index(key);
+    }
+
+    void JsonRef::remove_object_value(size_t index) noexcept {
+        v-> remove_object_value(index);
+    }
+
+    void JsonRef::clear_object() noexcept {
+        v-> clear_object();
+    }
+}